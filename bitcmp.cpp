@@ -0,0 +1,179 @@
+/***************************************************************************
+*                       Bit Stream Comparison Utility
+*
+*   File    : bitcmp.cpp
+*   Purpose : Compares two files as bit streams, like cmp, and reports the
+*             bit offset of the first difference and the number of bits
+*             that differ.  Each file may start at its own bit offset.
+*
+*             Usage: bitcmp file1 file2 [skip1 [skip2]]
+*
+*             skip1 and skip2 are the number of bits to skip at the start
+*             of each file (skip2 defaults to skip1).  The exit status is
+*             0 if the files are the same, 1 if they differ and 2 on
+*             trouble.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitcmp: A bit file library bit stream comparison program
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+#include <iostream>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include "bitcursor.h"
+#include "bitdiff.h"
+
+using namespace std;
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+#define EXIT_SAME       0
+#define EXIT_DIFFERENT  1
+#define EXIT_TROUBLE    2
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static bool ParseSkip(const char *arg, uint64_t *skip);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : main
+*   Description: This function compares the two files named on the
+*                command line and prints the result.
+*   Parameters : argc - number of parameters
+*                argv - parameter list
+*   Effects    : Writes the result to stdout.
+*   Returned   : EXIT_SAME, EXIT_DIFFERENT or EXIT_TROUBLE
+***************************************************************************/
+int main(int argc, char *argv[])
+{
+    bit_mapping_c mapA, mapB;
+    bf_compare_t result;
+    uint64_t skipA, skipB;
+
+    if ((argc < 3) || (argc > 5))
+    {
+        cerr << "Usage: " << argv[0] << " file1 file2 [skip1 [skip2]]" <<
+            endl;
+        return (EXIT_TROUBLE);
+    }
+
+    skipA = 0;
+
+    if ((argc > 3) && !ParseSkip(argv[3], &skipA))
+    {
+        cerr << "Error: Invalid Skip " << argv[3] << endl;
+        return (EXIT_TROUBLE);
+    }
+
+    skipB = skipA;
+
+    if ((argc > 4) && !ParseSkip(argv[4], &skipB))
+    {
+        cerr << "Error: Invalid Skip " << argv[4] << endl;
+        return (EXIT_TROUBLE);
+    }
+
+    try
+    {
+        mapA.Open(argv[1]);
+        mapB.Open(argv[2]);
+    }
+    catch (const char *errorMsg)
+    {
+        cerr << errorMsg << endl;
+        return (EXIT_TROUBLE);
+    }
+    catch (...)
+    {
+        cerr << "Unknown error opening file" << endl;
+        return (EXIT_TROUBLE);
+    }
+
+    if ((skipA > mapA.Bits()) || (skipB > mapB.Bits()))
+    {
+        cerr << "Error: Skip Past End Of File" << endl;
+        return (EXIT_TROUBLE);
+    }
+
+    mapA.Advise(BF_ACCESS_SEQUENTIAL);
+    mapB.Advise(BF_ACCESS_SEQUENTIAL);
+
+    bit_cursor_c a(mapA, skipA);
+    bit_cursor_c b(mapB, skipB);
+    uint64_t leftA = a.Remaining();
+    uint64_t leftB = b.Remaining();
+
+    CompareBits(a, b, (leftA > leftB) ? leftA : leftB, &result);
+
+    if (result.differences != 0)
+    {
+        cout << argv[1] << " " << argv[2] << " differ: bit " <<
+            result.first << ", " << result.differences << " of " <<
+            result.compared << " bits differ" << endl;
+    }
+
+    if (leftA != leftB)
+    {
+        cout << "EOF on " << ((leftA < leftB) ? argv[1] : argv[2]) <<
+            " after bit " << result.compared << endl;
+    }
+
+    if ((result.differences != 0) || (leftA != leftB))
+    {
+        return (EXIT_DIFFERENT);
+    }
+
+    return (EXIT_SAME);
+}
+
+/***************************************************************************
+*   Function   : ParseSkip
+*   Description: This function converts a skip argument to a bit count.
+*                It accepts decimal, octal (leading 0) and hex (leading
+*                0x) numbers, and nothing else.
+*   Parameters : arg - the argument
+*                skip - set to the number of bits to skip
+*   Effects    : None
+*   Returned   : true if arg is a whole number that fits in 64 bits.
+***************************************************************************/
+static bool ParseSkip(const char *arg, uint64_t *skip)
+{
+    char *end;
+
+    /* strtoull would negate a leading '-' rather than reject it */
+    if ((arg[0] < '0') || (arg[0] > '9'))
+    {
+        return false;
+    }
+
+    errno = 0;
+    *skip = strtoull(arg, &end, 0);
+
+    return ((0 == errno) && ('\0' == *end));
+}
@@ -0,0 +1,333 @@
+/***************************************************************************
+*                      Group Commit Implementation
+*
+*   File    : bitcommit.cpp
+*   Purpose : This file implements bit_committer_c.  Registered files are
+*             duplicated so that the writer may close them right away; the
+*             committer thread syncs and closes the duplicates a batch at
+*             a time.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <chrono>
+#include "bitcommit.h"
+
+using namespace std;
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : SyncData
+*   Description: This function makes the data of one file durable.
+*   Parameters : fd - file to sync
+*   Effects    : Flushes the file's data to the device.
+*   Returned   : 0 for success, otherwise EOF.
+***************************************************************************/
+static int SyncData(const int fd)
+{
+    while (fdatasync(fd) != 0)
+    {
+        if (errno != EINTR)
+        {
+            return EOF;
+        }
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : bit_committer_c - constructor
+*   Description: This method starts the committer thread.
+*   Parameters : intervalMs - milliseconds between batches
+*                method - BF_COMMIT_FDATASYNC or BF_COMMIT_SYNCFS.
+*                         BF_COMMIT_SYNCFS syncs every file on each file
+*                         system in the batch with one call; it is the
+*                         same as BF_COMMIT_FDATASYNC where syncfs isn't
+*                         available.
+*   Effects    : Starts a thread.
+*   Returned   : None
+***************************************************************************/
+bit_committer_c::bit_committer_c(const unsigned int intervalMs,
+    const BF_COMMIT_METHOD method) :
+    m_Interval(intervalMs),
+    m_Method(method),
+    m_Registered(0),
+    m_Committed(0),
+    m_Batches(0),
+    m_Failures(0),
+    m_Hurry(false),
+    m_Stop(false),
+    m_Thread(&bit_committer_c::Run, this)
+{
+}
+
+/***************************************************************************
+*   Method     : ~bit_committer_c - destructor
+*   Description: This method commits anything still registered and stops
+*                the committer thread.
+*   Parameters : None
+*   Effects    : Syncs pending files and joins the thread.
+*   Returned   : None
+***************************************************************************/
+bit_committer_c::~bit_committer_c(void)
+{
+    {
+        lock_guard<mutex> lock(m_Lock);
+        m_Stop = true;
+    }
+
+    m_Wake.notify_one();
+    m_Thread.join();
+}
+
+/***************************************************************************
+*   Method     : Register
+*   Description: This method adds the data written to a file to the next
+*                batch.  The caller must have written its buffered data
+*                to fd first.  fd is duplicated, so the caller may close it
+*                as soon as this returns.  If it can't be duplicated, the
+*                file is synced before returning instead.
+*   Parameters : fd - file descriptor of the file written
+*   Effects    : Queues a duplicate of fd for the committer thread.
+*   Returned   : 0 for success, otherwise EOF.
+***************************************************************************/
+int bit_committer_c::Register(const int fd)
+{
+    pending_t pending;
+    struct stat status;
+
+    if (fd < 0)
+    {
+        return EOF;
+    }
+
+    pending.fd = dup(fd);
+
+    if (pending.fd < 0)
+    {
+        /* out of descriptors; don't wait for the batch */
+        return SyncData(fd);
+    }
+
+    pending.device = 0;
+
+    if (fstat(pending.fd, &status) == 0)
+    {
+        pending.device = (uint64_t)status.st_dev;
+    }
+
+    lock_guard<mutex> lock(m_Lock);
+    m_Pending.push_back(pending);
+    m_Registered++;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Sync
+*   Description: This method waits until everything registered before it
+*                was called has been synced.  It asks for the pending batch
+*                to be started without waiting for the rest of the
+*                interval.
+*   Parameters : None
+*   Effects    : Blocks the calling thread.
+*   Returned   : EOF if any sync has failed since the committer was
+*                constructed, otherwise 0.
+***************************************************************************/
+int bit_committer_c::Sync(void)
+{
+    unique_lock<mutex> lock(m_Lock);
+    uint64_t target = m_Registered;
+
+    if (m_Committed < target)
+    {
+        m_Hurry = true;
+        m_Wake.notify_one();
+
+        while (m_Committed < target)
+        {
+            m_Done.wait(lock);
+        }
+    }
+
+    return (0 == m_Failures) ? 0 : EOF;
+}
+
+/***************************************************************************
+*   Method     : Batches
+*   Description: This method returns the number of batches synced.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of batches synced.
+***************************************************************************/
+uint64_t bit_committer_c::Batches(void)
+{
+    lock_guard<mutex> lock(m_Lock);
+    return m_Batches;
+}
+
+/***************************************************************************
+*   Method     : Failures
+*   Description: This method returns the number of syncs that failed.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of failed syncs.
+***************************************************************************/
+uint64_t bit_committer_c::Failures(void)
+{
+    lock_guard<mutex> lock(m_Lock);
+    return m_Failures;
+}
+
+/***************************************************************************
+*   Method     : Run
+*   Description: This method is the committer thread.  Once per interval,
+*                or sooner if Sync() is waiting, it takes the pending batch
+*                and syncs it without holding the lock, so writers can
+*                keep registering while the device flushes.
+*   Parameters : None
+*   Effects    : Syncs and closes registered descriptors.
+*   Returned   : None
+***************************************************************************/
+void bit_committer_c::Run(void)
+{
+    unique_lock<mutex> lock(m_Lock);
+
+    for (;;)
+    {
+        vector<pending_t> batch;
+        uint64_t registered;
+        unsigned int failures;
+
+        m_Wake.wait_for(lock, chrono::milliseconds(m_Interval),
+            [this] { return m_Stop || m_Hurry; });
+
+        if (m_Pending.empty())
+        {
+            m_Hurry = false;
+
+            if (m_Stop)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        batch.swap(m_Pending);
+        registered = m_Registered;
+        m_Hurry = false;
+
+        lock.unlock();
+        failures = Commit(batch);
+        lock.lock();
+
+        m_Committed = registered;
+        m_Batches++;
+        m_Failures += failures;
+        m_Done.notify_all();
+    }
+}
+
+/***************************************************************************
+*   Method     : Commit
+*   Description: This method syncs one batch and closes its descriptors.
+*                With BF_COMMIT_SYNCFS each file system is synced once,
+*                through the first of its files in the batch.  With
+*                BF_COMMIT_FDATASYNC writeback is started for every file
+*                before any is waited on, so the device sees the whole
+*                batch at once.
+*   Parameters : batch - registered descriptors
+*   Effects    : Syncs and closes every descriptor in batch.
+*   Returned   : Number of syncs that failed.
+***************************************************************************/
+unsigned int bit_committer_c::Commit(vector<pending_t> &batch)
+{
+    unsigned int failures;
+    size_t i, j;
+
+    failures = 0;
+
+#if defined(__linux__)
+    if (BF_COMMIT_FDATASYNC == m_Method)
+    {
+        for (i = 0; i < batch.size(); i++)
+        {
+            sync_file_range(batch[i].fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+        }
+    }
+#endif
+
+    for (i = 0; i < batch.size(); i++)
+    {
+        bool synced = false;
+
+#if defined(__linux__)
+        if (BF_COMMIT_SYNCFS == m_Method)
+        {
+            /* skip file systems already synced in this batch */
+            for (j = 0; j < i; j++)
+            {
+                if (batch[j].device == batch[i].device)
+                {
+                    synced = true;
+                    break;
+                }
+            }
+
+            if ((!synced) && (syncfs(batch[i].fd) != 0))
+            {
+                failures++;
+            }
+
+            synced = true;
+        }
+#else
+        (void)j;
+#endif
+
+        if ((!synced) && (SyncData(batch[i].fd) == EOF))
+        {
+            failures++;
+        }
+    }
+
+    for (i = 0; i < batch.size(); i++)
+    {
+        close(batch[i].fd);
+    }
+
+    return failures;
+}
@@ -0,0 +1,103 @@
+/***************************************************************************
+*                        Group Commit Header
+*
+*   File    : bitcommit.h
+*   Purpose : Provides definitions for bit_committer_c, which makes the
+*             data written by many compact mode bit files durable with a
+*             few batched syncs instead of one device flush per file.
+*             Writers using BF_DURABLE_GROUP register their file
+*             descriptor with the committer when they flush or close; a
+*             background thread syncs everything registered once per
+*             interval.  Sync() waits for the batch holding everything
+*             registered before it was called.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITCOMMIT_H
+#define __BITCOMMIT_H
+
+#include <stdint.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef enum
+{
+    BF_COMMIT_FDATASYNC,        /* fdatasync each registered file */
+    BF_COMMIT_SYNCFS            /* syncfs once per file system (Linux) */
+} BF_COMMIT_METHOD;
+
+class bit_committer_c
+{
+    public:
+        bit_committer_c(const unsigned int intervalMs = 10,
+            const BF_COMMIT_METHOD method = BF_COMMIT_FDATASYNC);
+        virtual ~bit_committer_c(void);
+
+        /* add a file's written data to the next batch */
+        int Register(const int fd);
+
+        /* wait until everything registered so far is durable */
+        int Sync(void);
+
+        /* number of batches synced and syncs that failed */
+        uint64_t Batches(void);
+        uint64_t Failures(void);
+
+    private:
+        typedef struct
+        {
+            int fd;                     /* duplicate of registered fd */
+            uint64_t device;            /* file system holding the file */
+        } pending_t;
+
+        unsigned int m_Interval;        /* ms between batches */
+        BF_COMMIT_METHOD m_Method;      /* how batches are synced */
+
+        std::mutex m_Lock;              /* protects everything below */
+        std::condition_variable m_Wake; /* wakes the committer thread */
+        std::condition_variable m_Done; /* signals finished batches */
+        std::vector<pending_t> m_Pending;   /* next batch */
+        uint64_t m_Registered;          /* registrations so far */
+        uint64_t m_Committed;           /* registrations made durable */
+        uint64_t m_Batches;             /* batches synced */
+        uint64_t m_Failures;            /* syncs that failed */
+        bool m_Hurry;                   /* a Sync() is waiting */
+        bool m_Stop;                    /* thread should exit */
+        std::thread m_Thread;           /* committer thread */
+
+        void Run(void);
+        unsigned int Commit(std::vector<pending_t> &batch);
+
+        /* committers may not be copied */
+        bit_committer_c(const bit_committer_c &);
+        bit_committer_c &operator=(const bit_committer_c &);
+};
+
+#endif  /* ndef __BITCOMMIT_H */
@@ -0,0 +1,702 @@
+/***************************************************************************
+*                Runtime CPU Feature Dispatch Implementation
+*
+*   File    : bitcpu.cpp
+*   Purpose : This file detects processor features once and builds the
+*             table of bit kernels used by the library.  Kernels for newer
+*             instruction sets are compiled with target attributes, so the
+*             library itself still builds and runs on any processor.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <string.h>
+#include "bitcpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITCPU_X86
+#endif
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : DetectFeatures
+*   Description: This function asks the processor which of the features
+*                the library can use it supports.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : BF_CPU_ bits.
+***************************************************************************/
+static unsigned int DetectFeatures(void)
+{
+    unsigned int features = 0;
+
+#ifdef BITCPU_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("sse2"))
+    {
+        features |= BF_CPU_SSE2;
+    }
+
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        features |= BF_CPU_SSSE3;
+    }
+
+    if (__builtin_cpu_supports("sse4.2"))
+    {
+        features |= BF_CPU_SSE42;
+    }
+
+    if (__builtin_cpu_supports("popcnt"))
+    {
+        features |= BF_CPU_POPCNT;
+    }
+
+    if (__builtin_cpu_supports("bmi2"))
+    {
+        features |= BF_CPU_BMI2;
+    }
+
+    if (__builtin_cpu_supports("avx2"))
+    {
+        features |= BF_CPU_AVX2;
+    }
+
+    if (__builtin_cpu_supports("avx512bw"))
+    {
+        features |= BF_CPU_AVX512BW;
+    }
+
+    if (__builtin_cpu_supports("gfni"))
+    {
+        features |= BF_CPU_GFNI;
+    }
+#endif
+
+    return features;
+}
+
+/***************************************************************************
+*   Function   : BitCpuFeatures
+*   Description: This function returns the features of the processor.
+*                They are detected the first time it is called, once, even
+*                if several threads get here at the same time.
+*   Parameters : None
+*   Effects    : Detects features on first call.
+*   Returned   : BF_CPU_ bits.
+***************************************************************************/
+unsigned int BitCpuFeatures(void)
+{
+    static const unsigned int features = DetectFeatures();
+
+    return features;
+}
+
+/***************************************************************************
+*   Function   : ShiftBytesSoftware
+*   Description: This function shifts a run of bytes right by shift bits,
+*                bringing in bits from the byte before each one.  It works
+*                from the last byte back, so dst may equal src.
+*   Parameters : dst - where to write the shifted bytes
+*                src - bytes to shift
+*                len - number of bytes
+*                shift - bits to shift (1 - 7)
+*                carry - the byte before src[0]
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+static void ShiftBytesSoftware(unsigned char *dst, const unsigned char *src,
+    size_t len, unsigned int shift, unsigned char carry)
+{
+    size_t i;
+
+    if (0 == len)
+    {
+        return;
+    }
+
+    for (i = len - 1; i > 0; i--)
+    {
+        dst[i] = (unsigned char)((src[i - 1] << (8 - shift)) |
+            (src[i] >> shift));
+    }
+
+    dst[0] = (unsigned char)((carry << (8 - shift)) | (src[0] >> shift));
+}
+
+/***************************************************************************
+*   Function   : PopCountSoftware
+*   Description: This function counts the 1 bits in a run of bytes 8 bytes
+*                at a time without special instructions.
+*   Parameters : data - bytes to count
+*                len - number of bytes
+*   Effects    : None
+*   Returned   : Number of 1 bits.
+***************************************************************************/
+static uint64_t PopCountSoftware(const unsigned char *data, size_t len)
+{
+    uint64_t count, word;
+    size_t i;
+
+    count = 0;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&word, data + i, sizeof(word));
+        word = word - ((word >> 1) & 0x5555555555555555ULL);
+        word = (word & 0x3333333333333333ULL) +
+            ((word >> 2) & 0x3333333333333333ULL);
+        word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        count += (word * 0x0101010101010101ULL) >> 56;
+    }
+
+    for (; i < len; i++)
+    {
+        unsigned int b = data[i];
+
+        while (b != 0)
+        {
+            count++;
+            b &= b - 1;
+        }
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Function   : ExpandBitsSoftware
+*   Description: This function writes one byte (0 or 1) for every bit in a
+*                run of bytes, msb first.
+*   Parameters : dst - where to write 8 * len bytes
+*                src - bits to expand
+*                len - number of bytes in src
+*   Effects    : Writes 8 * len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+static void ExpandBitsSoftware(uint8_t *dst, const unsigned char *src,
+    size_t len)
+{
+    size_t i;
+    int bit;
+
+    for (i = 0; i < len; i++)
+    {
+        for (bit = 0; bit < 8; bit++)
+        {
+            dst[(8 * i) + bit] = (src[i] >> (7 - bit)) & 0x01;
+        }
+    }
+}
+
+/***************************************************************************
+*   Function   : CompressBitsSoftware
+*   Description: This function packs one bit for every byte of a run of
+*                bytes, msb first.  Any nonzero byte is a 1.
+*   Parameters : dst - where to write len bytes
+*                src - 8 * len bytes to pack
+*                len - number of bytes in dst
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+static void CompressBitsSoftware(unsigned char *dst, const uint8_t *src,
+    size_t len)
+{
+    size_t i;
+    int bit;
+
+    for (i = 0; i < len; i++)
+    {
+        unsigned char c = 0;
+
+        for (bit = 0; bit < 8; bit++)
+        {
+            c = (unsigned char)((c << 1) | (src[(8 * i) + bit] != 0));
+        }
+
+        dst[i] = c;
+    }
+}
+
+/***************************************************************************
+*   Function   : FirstDiff
+*   Description: This function finds the first byte that differs between
+*                two runs of bytes known to differ.
+*   Parameters : a - first run of bytes
+*                b - second run of bytes
+*                i - index to start looking from
+*   Effects    : None
+*   Returned   : Index of the first byte that differs.
+***************************************************************************/
+static inline size_t FirstDiff(const unsigned char *a, const unsigned char *b,
+    size_t i)
+{
+    while (a[i] == b[i])
+    {
+        i++;
+    }
+
+    return i;
+}
+
+/***************************************************************************
+*   Function   : DiffBitsSoftware
+*   Description: This function counts the bits that differ between two
+*                runs of bytes 8 bytes at a time without special
+*                instructions.
+*   Parameters : a - first run of bytes
+*                b - second run of bytes
+*                len - number of bytes in each
+*                first - set to the index of the first byte that differs
+*                        (len if none do)
+*   Effects    : None
+*   Returned   : Number of bits that differ.
+***************************************************************************/
+static uint64_t DiffBitsSoftware(const unsigned char *a,
+    const unsigned char *b, size_t len, size_t *first)
+{
+    uint64_t count, wordA, wordB;
+    size_t i;
+
+    count = 0;
+    *first = len;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&wordA, a + i, sizeof(wordA));
+        memcpy(&wordB, b + i, sizeof(wordB));
+
+        if (wordA != wordB)
+        {
+            unsigned char x[8];
+
+            if (len == *first)
+            {
+                *first = FirstDiff(a, b, i);
+            }
+
+            wordA ^= wordB;
+            memcpy(x, &wordA, sizeof(x));
+            count += PopCountSoftware(x, sizeof(x));
+        }
+    }
+
+    for (; i < len; i++)
+    {
+        if (a[i] != b[i])
+        {
+            unsigned char x = a[i] ^ b[i];
+
+            if (len == *first)
+            {
+                *first = i;
+            }
+
+            count += PopCountSoftware(&x, 1);
+        }
+    }
+
+    return count;
+}
+
+#ifdef BITCPU_X86
+/***************************************************************************
+*   Function   : ShiftBytesAvx2
+*   Description: This function is ShiftBytesSoftware for 32 bytes at a
+*                time.  x86 has no byte shifts, so bytes are shifted as 16
+*                bit lanes and the bits that cross into the neighboring
+*                byte are masked off.  Each block is loaded before it is
+*                stored and blocks go from last to first, so dst may equal
+*                src.
+*   Parameters : dst - where to write the shifted bytes
+*                src - bytes to shift
+*                len - number of bytes
+*                shift - bits to shift (1 - 7)
+*                carry - the byte before src[0]
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("avx2")))
+static void ShiftBytesAvx2(unsigned char *dst, const unsigned char *src,
+    size_t len, unsigned int shift, unsigned char carry)
+{
+    const __m128i right = _mm_cvtsi32_si128((int)shift);
+    const __m128i left = _mm_cvtsi32_si128((int)(8 - shift));
+    const __m256i lowMask = _mm256_set1_epi8((char)(0xFF >> shift));
+    const __m256i highMask = _mm256_set1_epi8((char)(0xFF << (8 - shift)));
+    size_t i;
+
+    for (i = len; i >= 33; i -= 32)
+    {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(src + i - 32));
+        __m256i prev = _mm256_loadu_si256((const __m256i *)(src + i - 33));
+
+        cur = _mm256_and_si256(_mm256_srl_epi16(cur, right), lowMask);
+        prev = _mm256_and_si256(_mm256_sll_epi16(prev, left), highMask);
+        _mm256_storeu_si256((__m256i *)(dst + i - 32),
+            _mm256_or_si256(cur, prev));
+    }
+
+    ShiftBytesSoftware(dst, src, i, shift, carry);
+}
+
+/***************************************************************************
+*   Function   : ShiftBytesAvx512
+*   Description: This function is ShiftBytesAvx2 for 64 bytes at a time.
+*   Parameters : dst - where to write the shifted bytes
+*                src - bytes to shift
+*                len - number of bytes
+*                shift - bits to shift (1 - 7)
+*                carry - the byte before src[0]
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("avx512bw")))
+static void ShiftBytesAvx512(unsigned char *dst, const unsigned char *src,
+    size_t len, unsigned int shift, unsigned char carry)
+{
+    const __m128i right = _mm_cvtsi32_si128((int)shift);
+    const __m128i left = _mm_cvtsi32_si128((int)(8 - shift));
+    const __m512i lowMask = _mm512_set1_epi8((char)(0xFF >> shift));
+    const __m512i highMask = _mm512_set1_epi8((char)(0xFF << (8 - shift)));
+    size_t i;
+
+    for (i = len; i >= 65; i -= 64)
+    {
+        __m512i cur = _mm512_loadu_si512((const void *)(src + i - 64));
+        __m512i prev = _mm512_loadu_si512((const void *)(src + i - 65));
+
+        cur = _mm512_and_si512(_mm512_srl_epi16(cur, right), lowMask);
+        prev = _mm512_and_si512(_mm512_sll_epi16(prev, left), highMask);
+        _mm512_storeu_si512((void *)(dst + i - 64),
+            _mm512_or_si512(cur, prev));
+    }
+
+    ShiftBytesSoftware(dst, src, i, shift, carry);
+}
+
+/***************************************************************************
+*   Function   : ExpandBitsAvx2
+*   Description: This function is ExpandBitsSoftware for 4 bytes (32 bits)
+*                at a time.  Each source byte is copied to 8 lanes, each
+*                lane is anded with its own bit and compared against it.
+*   Parameters : dst - where to write 8 * len bytes
+*                src - bits to expand
+*                len - number of bytes in src
+*   Effects    : Writes 8 * len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("avx2")))
+static void ExpandBitsAvx2(uint8_t *dst, const unsigned char *src,
+    size_t len)
+{
+    const __m256i spread = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+        2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i select = _mm256_set1_epi64x(
+        (long long)0x0102040810204080ULL);
+    const __m256i one = _mm256_set1_epi8(1);
+    size_t i;
+
+    for (i = 0; i + 4 <= len; i += 4)
+    {
+        int32_t word;
+        __m256i v;
+
+        memcpy(&word, src + i, sizeof(word));
+        v = _mm256_shuffle_epi8(_mm256_set1_epi32(word), spread);
+        v = _mm256_cmpeq_epi8(_mm256_and_si256(v, select), select);
+        _mm256_storeu_si256((__m256i *)(dst + (8 * i)),
+            _mm256_and_si256(v, one));
+    }
+
+    ExpandBitsSoftware(dst + (8 * i), src + i, len - i);
+}
+
+/***************************************************************************
+*   Function   : CompressBitsAvx2
+*   Description: This function is CompressBitsSoftware for 32 bytes at a
+*                time.  The bytes of each group of 8 are reversed so that
+*                pmovmskb puts the first of them in the msb.
+*   Parameters : dst - where to write len bytes
+*                src - 8 * len bytes to pack
+*                len - number of bytes in dst
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("avx2")))
+static void CompressBitsAvx2(unsigned char *dst, const uint8_t *src,
+    size_t len)
+{
+    const __m256i reverse = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i;
+
+    for (i = 0; i + 4 <= len; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + (8 * i)));
+        uint32_t mask;
+
+        v = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(v, reverse), zero);
+        mask = ~(uint32_t)_mm256_movemask_epi8(v);
+        memcpy(dst + i, &mask, sizeof(mask));
+    }
+
+    CompressBitsSoftware(dst + i, src + (8 * i), len - i);
+}
+
+/***************************************************************************
+*   Function   : ExpandBitsBmi2
+*   Description: This function is ExpandBitsSoftware with pdep.  pdep
+*                deposits the 8 bits of a byte in the low bits of 8 bytes,
+*                first bit in the lowest byte, so the word is byte swapped
+*                to put the msb's byte first in memory.
+*   Parameters : dst - where to write 8 * len bytes
+*                src - bits to expand
+*                len - number of bytes in src
+*   Effects    : Writes 8 * len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("bmi2")))
+static void ExpandBitsBmi2(uint8_t *dst, const unsigned char *src,
+    size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        uint64_t word = __builtin_bswap64(
+            _pdep_u64(src[i], 0x0101010101010101ULL));
+
+        memcpy(dst + (8 * i), &word, sizeof(word));
+    }
+}
+
+/***************************************************************************
+*   Function   : CompressBitsBmi2
+*   Description: This function is CompressBitsSoftware with pext.  Adding
+*                0x7F to the low 7 bits of each byte carries into its high
+*                bit unless they are all 0, so or-ing in the byte leaves
+*                the high bit set for every nonzero byte.  pext gathers the
+*                high bits; the word is byte swapped first so the first
+*                byte lands in the msb.
+*   Parameters : dst - where to write len bytes
+*                src - 8 * len bytes to pack
+*                len - number of bytes in dst
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("bmi2")))
+static void CompressBitsBmi2(unsigned char *dst, const uint8_t *src,
+    size_t len)
+{
+    const uint64_t low = 0x7F7F7F7F7F7F7F7FULL;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        uint64_t word;
+
+        memcpy(&word, src + (8 * i), sizeof(word));
+        word = __builtin_bswap64(word);
+        word |= (word & low) + low;
+        dst[i] = (unsigned char)_pext_u64(word, 0x8080808080808080ULL);
+    }
+}
+
+/***************************************************************************
+*   Function   : DiffBitsAvx2
+*   Description: This function is DiffBitsSoftware for 32 bytes at a
+*                time.  Blocks that match are skipped after a single test;
+*                the 1 bits in the xor of blocks that don't are counted
+*                with a pshufb nibble lookup and summed with psadbw.
+*   Parameters : a - first run of bytes
+*                b - second run of bytes
+*                len - number of bytes in each
+*                first - set to the index of the first byte that differs
+*                        (len if none do)
+*   Effects    : None
+*   Returned   : Number of bits that differ.
+***************************************************************************/
+__attribute__((target("avx2")))
+static uint64_t DiffBitsAvx2(const unsigned char *a, const unsigned char *b,
+    size_t len, size_t *first)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    uint64_t count, sums[4];
+    size_t i, tailFirst;
+
+    *first = len;
+
+    for (i = 0; i + 32 <= len; i += 32)
+    {
+        __m256i x = _mm256_xor_si256(
+            _mm256_loadu_si256((const __m256i *)(a + i)),
+            _mm256_loadu_si256((const __m256i *)(b + i)));
+
+        if (!_mm256_testz_si256(x, x))
+        {
+            __m256i bits;
+
+            if (len == *first)
+            {
+                *first = FirstDiff(a, b, i);
+            }
+
+            bits = _mm256_add_epi8(
+                _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, nibble)),
+                _mm256_shuffle_epi8(lookup,
+                    _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble)));
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(bits, zero));
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *)sums, total);
+    count = sums[0] + sums[1] + sums[2] + sums[3];
+    count += DiffBitsSoftware(a + i, b + i, len - i, &tailFirst);
+
+    if ((len == *first) && (tailFirst != (len - i)))
+    {
+        *first = i + tailFirst;
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Function   : PopCountPopcnt
+*   Description: This function counts the 1 bits in a run of bytes with
+*                the popcnt instruction.
+*   Parameters : data - bytes to count
+*                len - number of bytes
+*   Effects    : None
+*   Returned   : Number of 1 bits.
+***************************************************************************/
+__attribute__((target("popcnt")))
+static uint64_t PopCountPopcnt(const unsigned char *data, size_t len)
+{
+    uint64_t count, word;
+    size_t i;
+
+    count = 0;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&word, data + i, sizeof(word));
+        count += (uint64_t)__builtin_popcountll(word);
+    }
+
+    for (; i < len; i++)
+    {
+        count += (uint64_t)__builtin_popcount(data[i]);
+    }
+
+    return count;
+}
+#endif
+
+/***************************************************************************
+*   Function   : SelectKernels
+*   Description: This function fills in the kernel table with the fastest
+*                kernels the processor supports.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : The kernel table.
+***************************************************************************/
+static bf_cpu_kernels_t SelectKernels(void)
+{
+    bf_cpu_kernels_t kernels;
+
+    kernels.name = "generic";
+    kernels.ShiftBytes = ShiftBytesSoftware;
+    kernels.PopCount = PopCountSoftware;
+    kernels.ExpandBits = ExpandBitsSoftware;
+    kernels.CompressBits = CompressBitsSoftware;
+    kernels.DiffBits = DiffBitsSoftware;
+
+#ifdef BITCPU_X86
+    unsigned int features = BitCpuFeatures();
+
+    if (features & BF_CPU_POPCNT)
+    {
+        kernels.name = "popcnt";
+        kernels.PopCount = PopCountPopcnt;
+    }
+
+    if (features & BF_CPU_BMI2)
+    {
+        kernels.name = "bmi2";
+        kernels.ExpandBits = ExpandBitsBmi2;
+        kernels.CompressBits = CompressBitsBmi2;
+    }
+
+    if (features & BF_CPU_AVX2)
+    {
+        kernels.name = "avx2";
+        kernels.ShiftBytes = ShiftBytesAvx2;
+        kernels.ExpandBits = ExpandBitsAvx2;
+        kernels.CompressBits = CompressBitsAvx2;
+        kernels.DiffBits = DiffBitsAvx2;
+    }
+
+    if (features & BF_CPU_AVX512BW)
+    {
+        kernels.name = "avx512bw";
+        kernels.ShiftBytes = ShiftBytesAvx512;
+    }
+#endif
+
+    return kernels;
+}
+
+/***************************************************************************
+*   Function   : BitCpuKernels
+*   Description: This function returns the kernel table.  It is built the
+*                first time the function is called, once, even if several
+*                threads get here at the same time.
+*   Parameters : None
+*   Effects    : Builds the table on first call.
+*   Returned   : Pointer to the kernel table.
+***************************************************************************/
+const bf_cpu_kernels_t *BitCpuKernels(void)
+{
+    static const bf_cpu_kernels_t kernels = SelectKernels();
+
+    return &kernels;
+}
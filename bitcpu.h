@@ -0,0 +1,94 @@
+/***************************************************************************
+*                   Runtime CPU Feature Dispatch Header
+*
+*   File    : bitcpu.h
+*   Purpose : Provides definitions and prototypes for detecting processor
+*             features at run time and for the table of bit kernels chosen
+*             from them.  The library is built for a generic processor;
+*             code that can use newer instructions asks BitCpuFeatures()
+*             whether they are available, and bit_file_c gets its kernels
+*             from BitCpuKernels() when it is constructed.  Every kernel
+*             has a portable version.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITCPU_H
+#define __BITCPU_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+/* BitCpuFeatures() bits */
+#define BF_CPU_SSE2         0x0001
+#define BF_CPU_SSSE3        0x0002
+#define BF_CPU_SSE42        0x0004
+#define BF_CPU_POPCNT       0x0008
+#define BF_CPU_BMI2         0x0010
+#define BF_CPU_AVX2         0x0020
+#define BF_CPU_AVX512BW     0x0040
+#define BF_CPU_GFNI         0x0080
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct
+{
+    const char *name;               /* widest instruction set used */
+
+    /* dst[i] = (src[i - 1] << (8 - shift)) | (src[i] >> shift), where
+     * src[-1] is carry and shift is 1 - 7.  dst may equal src. */
+    void (*ShiftBytes)(unsigned char *dst, const unsigned char *src,
+        size_t len, unsigned int shift, unsigned char carry);
+
+    /* number of 1 bits in len bytes */
+    uint64_t (*PopCount)(const unsigned char *data, size_t len);
+
+    /* dst gets 8 * len bytes, each 0 or 1, one per bit of src (msb first) */
+    void (*ExpandBits)(uint8_t *dst, const unsigned char *src, size_t len);
+
+    /* inverse of ExpandBits; any nonzero src byte is a 1 bit */
+    void (*CompressBits)(unsigned char *dst, const uint8_t *src,
+        size_t len);
+
+    /* number of bits that differ between a and b.  *first gets the index
+     * of the first byte that differs, or len if they are the same. */
+    uint64_t (*DiffBits)(const unsigned char *a, const unsigned char *b,
+        size_t len, size_t *first);
+} bf_cpu_kernels_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* BF_CPU_ bits for the features this processor supports */
+unsigned int BitCpuFeatures(void);
+
+/* the fastest kernels this processor supports */
+const bf_cpu_kernels_t *BitCpuKernels(void);
+
+#endif  /* ndef __BITCPU_H */
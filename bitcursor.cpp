@@ -0,0 +1,851 @@
+/***************************************************************************
+*              Shared Bit File Mapping and Cursor Implementation
+*
+*   File    : bitcursor.cpp
+*   Purpose : This file implements a read-only memory mapping of a bit file
+*             that may be shared by many threads, and lightweight cursors
+*             that read bits from the mapping.  Cursors never modify the
+*             mapping, so any number of threads may read from one mapping
+*             without locking as long as each thread uses its own cursors.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bitcursor.h"
+#include "bitfile.h"
+#include "bitcpu.h"
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* mappings this large are offered transparent huge pages */
+#define BF_HUGE_PAGE    ((uint64_t)2 << 20)
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* union used to test for endianess */
+typedef union
+{
+    unsigned long word;
+    unsigned char bytes[sizeof(unsigned long)];
+} endian_test_t;
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : MachineEndian
+*   Description: This function determines the endianess of the machine.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : BF_LITTLE_ENDIAN, BF_BIG_ENDIAN, or BF_UNKNOWN_ENDIAN
+***************************************************************************/
+static endian_t MachineEndian(void)
+{
+    endian_test_t endianTest;
+
+    endianTest.word = 1;
+
+    if (endianTest.bytes[0] == 1)
+    {
+        /* LSB is 1st byte (little endian)*/
+        return BF_LITTLE_ENDIAN;
+    }
+    else if (endianTest.bytes[sizeof(unsigned long) - 1] == 1)
+    {
+        /* LSB is last byte (big endian)*/
+        return BF_BIG_ENDIAN;
+    }
+
+    return BF_UNKNOWN_ENDIAN;
+}
+
+/***************************************************************************
+*                          bit_mapping_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_mapping_c - default constructor
+*   Description: This is the default bit_mapping_c constructor.  It
+*                creates an object without a mapped file.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_mapping_c::bit_mapping_c(void)
+{
+    m_Data = NULL;
+    m_Size = 0;
+}
+
+/***************************************************************************
+*   Method     : bit_mapping_c - constructor
+*   Description: This is a bit_mapping_c constructor.  It maps the named
+*                file for reading.  An exception will be thrown on error.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the file to be mapped.
+*   Effects    : Maps the file.
+*   Returned   : None
+*   Exception  : "Error: Unable To Open File" - if file cannot be mapped
+***************************************************************************/
+bit_mapping_c::bit_mapping_c(const char *fileName)
+{
+    m_Data = NULL;
+    m_Size = 0;
+
+    Open(fileName);
+}
+
+/***************************************************************************
+*   Method     : ~bit_mapping_c - destructor
+*   Description: This is the bit_mapping_c destructor.  It unmaps any
+*                mapped file.  Cursors using the mapping become invalid.
+*   Parameters : None
+*   Effects    : Unmaps the file.
+*   Returned   : None
+***************************************************************************/
+bit_mapping_c::~bit_mapping_c(void)
+{
+    Close();
+}
+
+/***************************************************************************
+*   Method     : Open
+*   Description: This method maps a file for reading.  An exception will
+*                be thrown on error.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the file to be mapped.
+*   Effects    : Maps the file.  The file descriptor used to create the
+*                mapping is closed before returning.
+*   Returned   : None
+*   Exception  : "Error: File Already Open" - if object has a mapped file
+*                "Error: Unable To Open File" - if file cannot be mapped
+***************************************************************************/
+void bit_mapping_c::Open(const char *fileName)
+{
+    struct stat status;
+    void *data;
+    int fd;
+
+    if (m_Data != NULL)
+    {
+        throw("Error: File Already Open");
+    }
+
+    fd = open(fileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        throw("Error: Unable To Open File");
+    }
+
+    if (fstat(fd, &status) != 0)
+    {
+        close(fd);
+        throw("Error: Unable To Open File");
+    }
+
+    m_Size = (uint64_t)status.st_size;
+
+    if (0 == m_Size)
+    {
+        /* nothing to map */
+        close(fd);
+        return;
+    }
+
+    data = mmap(NULL, m_Size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (MAP_FAILED == data)
+    {
+        m_Size = 0;
+        throw("Error: Unable To Open File");
+    }
+
+    m_Data = (unsigned char *)data;
+
+#if defined(MADV_HUGEPAGE)
+    if (m_Size >= BF_HUGE_PAGE)
+    {
+        /* fewer TLB misses where file huge pages are supported */
+        madvise(data, m_Size, MADV_HUGEPAGE);
+    }
+#endif
+}
+
+/***************************************************************************
+*   Method     : Advise
+*   Description: This method tells the kernel how the mapping will be
+*                read.  BF_ACCESS_SEQUENTIAL also starts reading the file
+*                in, so the first pages don't fault one at a time.
+*   Parameters : access - BF_ACCESS_NORMAL, BF_ACCESS_SEQUENTIAL or
+*                         BF_ACCESS_RANDOM
+*   Effects    : Changes kernel read ahead for the mapping.
+*   Returned   : EOF if nothing is mapped or the kernel rejects the hint,
+*                otherwise 0.
+***************************************************************************/
+int bit_mapping_c::Advise(const BF_ACCESS access) const
+{
+    int advice;
+
+    if (m_Data == NULL)
+    {
+        return EOF;
+    }
+
+    switch (access)
+    {
+        case BF_ACCESS_SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+
+        case BF_ACCESS_RANDOM:
+            advice = MADV_RANDOM;
+            break;
+
+        default:
+            advice = MADV_NORMAL;
+            break;
+    }
+
+    if (madvise(m_Data, m_Size, advice) != 0)
+    {
+        return EOF;
+    }
+
+    if (BF_ACCESS_SEQUENTIAL == access)
+    {
+        return WillNeed(0, Bits());
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : WillNeed
+*   Description: This method asks the kernel to start reading a range of
+*                the mapping in before a cursor gets to it.
+*   Parameters : bitOffset - first bit of the range
+*                count - number of bits in the range
+*   Effects    : Starts read ahead.
+*   Returned   : EOF if nothing is mapped, the range is outside the
+*                mapping or the kernel rejects the hint, otherwise 0.
+***************************************************************************/
+int bit_mapping_c::WillNeed(const uint64_t bitOffset, const uint64_t count)
+    const
+{
+    uint64_t first, last, page;
+
+    if ((m_Data == NULL) || (bitOffset > Bits()) ||
+        (count > Bits() - bitOffset))
+    {
+        return EOF;
+    }
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    /* madvise wants a page aligned address */
+    page = (uint64_t)sysconf(_SC_PAGESIZE);
+    first = (bitOffset / 8) & ~(page - 1);
+    last = (bitOffset + count + 7) / 8;
+
+    if (madvise(m_Data + first, last - first, MADV_WILLNEED) != 0)
+    {
+        return EOF;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Close
+*   Description: This method unmaps the mapped file.  Cursors using the
+*                mapping become invalid.
+*   Parameters : None
+*   Effects    : Unmaps the file and resets member variables.
+*   Returned   : None
+***************************************************************************/
+void bit_mapping_c::Close(void)
+{
+    if (m_Data != NULL)
+    {
+        munmap(m_Data, m_Size);
+    }
+
+    m_Data = NULL;
+    m_Size = 0;
+}
+
+/***************************************************************************
+*   Method     : Data
+*   Description: This method returns the mapped bytes.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Pointer to the mapped file.  NULL if nothing is mapped.
+***************************************************************************/
+const unsigned char *bit_mapping_c::Data(void) const
+{
+    return m_Data;
+}
+
+/***************************************************************************
+*   Method     : Size
+*   Description: This method returns the size of the mapped file in bytes.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of bytes mapped.
+***************************************************************************/
+uint64_t bit_mapping_c::Size(void) const
+{
+    return m_Size;
+}
+
+/***************************************************************************
+*   Method     : Bits
+*   Description: This method returns the size of the mapped file in bits.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of bits mapped.
+***************************************************************************/
+uint64_t bit_mapping_c::Bits(void) const
+{
+    return m_Size * 8;
+}
+
+/***************************************************************************
+*                           bit_cursor_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_cursor_c - default constructor
+*   Description: This is the default bit_cursor_c constructor.  It creates
+*                a cursor with no bits to read.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_cursor_c::bit_cursor_c(void)
+{
+    m_Data = NULL;
+    m_Size = 0;
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+}
+
+/***************************************************************************
+*   Method     : bit_cursor_c - constructor
+*   Description: This is a bit_cursor_c constructor for reading a mapped
+*                file.  The mapping must outlive the cursor.
+*   Parameters : mapping - the mapped file to read
+*                bitOffset - bit position of the first bit to read
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_cursor_c::bit_cursor_c(const bit_mapping_c &mapping,
+    const uint64_t bitOffset)
+{
+    m_Data = mapping.Data();
+    m_Size = mapping.Size();
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    Seek(bitOffset);
+}
+
+/***************************************************************************
+*   Method     : bit_cursor_c - constructor
+*   Description: This is a bit_cursor_c constructor for reading bits from
+*                memory.  The memory must outlive the cursor.
+*   Parameters : data - the bytes to read
+*                size - number of bytes in data
+*                bitOffset - bit position of the first bit to read
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_cursor_c::bit_cursor_c(const void *data, const uint64_t size,
+    const uint64_t bitOffset)
+{
+    m_Data = (const unsigned char *)data;
+    m_Size = size;
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    Seek(bitOffset);
+}
+
+/***************************************************************************
+*   Method     : Seek
+*   Description: This method moves the cursor to an absolute bit position.
+*   Parameters : bitOffset - bit position of the next bit to read
+*   Effects    : Clears the bit buffer and moves the cursor.
+*   Returned   : EOF if the position is past the end of the data.
+*                Otherwise 0.
+***************************************************************************/
+int bit_cursor_c::Seek(const uint64_t bitOffset)
+{
+    if (bitOffset > (m_Size * 8))
+    {
+        return EOF;
+    }
+
+    m_Next = bitOffset / 8;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    if ((bitOffset % 8) != 0)
+    {
+        /* keep the unread bits of the partial byte */
+        m_BitCount = 8 - (bitOffset % 8);
+        m_BitBuffer = m_Data[m_Next] & (0xFF >> (bitOffset % 8));
+        m_Next++;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Remaining
+*   Description: This method returns the number of bits left to read.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of bits between the cursor and the end of data.
+***************************************************************************/
+uint64_t bit_cursor_c::Remaining(void) const
+{
+    return ((m_Size - m_Next) * 8) + m_BitCount;
+}
+
+/***************************************************************************
+*   Method     : Tell
+*   Description: This method returns the bit position of the cursor.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Bit position of the next bit to be read.
+***************************************************************************/
+uint64_t bit_cursor_c::Tell(void) const
+{
+    return (m_Next * 8) - m_BitCount;
+}
+
+/***************************************************************************
+*   Method     : ByteAlign
+*   Description: This method aligns the cursor to the next byte boundary
+*                by discarding any bits left in a partially read byte.
+*   Parameters : None
+*   Effects    : Discards bits from the bit buffer.
+*   Returned   : The number of bits discarded.
+***************************************************************************/
+int bit_cursor_c::ByteAlign(void)
+{
+    int discard = m_BitCount % 8;
+
+    m_BitCount -= discard;
+    m_BitBuffer &= ((uint64_t)1 << m_BitCount) - 1;
+
+    return discard;
+}
+
+/***************************************************************************
+*   Method     : Fill
+*   Description: This method loads whole bytes into the bit buffer until it
+*                holds at least 56 bits or the data is exhausted.  When 8
+*                bytes are available they are loaded with a single read.
+*   Parameters : None
+*   Effects    : Updates the bit buffer and the next byte position.
+*   Returned   : None
+***************************************************************************/
+void bit_cursor_c::Fill(void)
+{
+    unsigned int bytes;
+
+    if (m_Next + 8 <= m_Size)
+    {
+        uint64_t word;
+        int i;
+
+        word = 0;
+
+        for (i = 0; i < 8; i++)
+        {
+            word = (word << 8) | m_Data[m_Next + i];
+        }
+
+        /* at most 7 bytes so the shift is always less than 64 */
+        bytes = (63 - m_BitCount) / 8;
+
+        if (0 == bytes)
+        {
+            return;
+        }
+
+        m_BitBuffer = (m_BitBuffer << (bytes * 8)) |
+            (word >> (64 - (bytes * 8)));
+        m_BitCount += bytes * 8;
+        m_Next += bytes;
+        return;
+    }
+
+    while ((m_BitCount <= 56) && (m_Next < m_Size))
+    {
+        m_BitBuffer = (m_BitBuffer << 8) | m_Data[m_Next];
+        m_BitCount += 8;
+        m_Next++;
+    }
+}
+
+/***************************************************************************
+*   Method     : GetChar
+*   Description: This method returns the next byte from the cursor.
+*   Parameters : None
+*   Effects    : Advances the cursor 8 bits.
+*   Returned   : EOF if a whole byte cannot be obtained.  Otherwise,
+*                the character read.
+***************************************************************************/
+int bit_cursor_c::GetChar(void)
+{
+    if (m_BitCount < 8)
+    {
+        Fill();
+
+        if (m_BitCount < 8)
+        {
+            return EOF;
+        }
+    }
+
+    m_BitCount -= 8;
+    return (int)((m_BitBuffer >> m_BitCount) & 0xFF);
+}
+
+/***************************************************************************
+*   Method     : GetBit
+*   Description: This method returns the next bit from the cursor.
+*   Parameters : None
+*   Effects    : Advances the cursor 1 bit.
+*   Returned   : 0 if bit == 0, 1 if bit == 1, and EOF if operation fails.
+***************************************************************************/
+int bit_cursor_c::GetBit(void)
+{
+    if (0 == m_BitCount)
+    {
+        Fill();
+
+        if (0 == m_BitCount)
+        {
+            return EOF;
+        }
+    }
+
+    m_BitCount--;
+    return (int)((m_BitBuffer >> m_BitCount) & 0x01);
+}
+
+/***************************************************************************
+*   Method     : GetBits
+*   Description: This method reads the specified number of bits from the
+*                cursor and writes them to the requested memory location
+*                (msb to lsb).  Runs of whole bytes are copied directly
+*                from the data, and shifted into place if the cursor isn't
+*                byte aligned.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*   Effects    : Advances the cursor.
+*   Returned   : EOF for failure, otherwise the number of bits read.  If
+*                an EOF is reached before all the bits are read, bits
+*                will contain every bit through the last complete byte.
+***************************************************************************/
+int64_t bit_cursor_c::GetBits(void *bits, const uint64_t count)
+{
+    unsigned char *bytes;
+    uint64_t offset, remaining;
+    int returnValue;
+
+    if (bits == NULL)
+    {
+        return EOF;
+    }
+
+    bytes = (unsigned char *)bits;
+    offset = 0;
+    remaining = count;
+
+    /* empty whole bytes from the bit buffer then copy whole bytes */
+    while ((remaining >= 8) && (m_BitCount >= 8))
+    {
+        m_BitCount -= 8;
+        bytes[offset] = (unsigned char)(m_BitBuffer >> m_BitCount);
+        remaining -= 8;
+        offset++;
+    }
+
+    if (remaining >= 8)
+    {
+        uint64_t copy = remaining / 8;
+
+        if (copy > (m_Size - m_Next))
+        {
+            copy = m_Size - m_Next;
+        }
+
+        if (0 == m_BitCount)
+        {
+            memcpy(bytes + offset, m_Data + m_Next, copy);
+        }
+        else if (copy != 0)
+        {
+            /* shift in behind the bits left in the buffer */
+            BitCpuKernels()->ShiftBytes(bytes + offset, m_Data + m_Next,
+                copy, m_BitCount, (unsigned char)m_BitBuffer);
+            m_BitBuffer = m_Data[m_Next + copy - 1];
+        }
+
+        m_Next += copy;
+        remaining -= copy * 8;
+        offset += copy;
+    }
+
+    /* read whole bytes */
+    while (remaining >= 8)
+    {
+        returnValue = GetChar();
+
+        if (returnValue == EOF)
+        {
+            return EOF;
+        }
+
+        bytes[offset] = (unsigned char)returnValue;
+        remaining -= 8;
+        offset++;
+    }
+
+    if (remaining != 0)
+    {
+        /* read remaining bits and left justify them */
+        if (m_BitCount < remaining)
+        {
+            Fill();
+
+            if (m_BitCount < remaining)
+            {
+                return EOF;
+            }
+        }
+
+        m_BitCount -= remaining;
+        bytes[offset] = (unsigned char)
+            (((m_BitBuffer >> m_BitCount) << (8 - remaining)) & 0xFF);
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method:    : GetBitsInt
+*   Description: This method provides a machine independent layer that
+*                allows a single call to stuff an arbitrary number of bits
+*                read from the cursor into an integer type variable (short,
+*                int, long, ...).  The results match bit_file_c::GetBitsInt.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*                size - sizeof type containing "bits"
+*   Effects    : Advances the cursor.
+*   Returned   : EOF for failure, otherwise the number of bits read.  An
+*                error is thrown if the machine endianess is unknown.
+***************************************************************************/
+int bit_cursor_c::GetBitsInt(void *bits, const unsigned int count,
+    const size_t size)
+{
+    static const endian_t endian = MachineEndian();
+
+    if (bits == NULL)
+    {
+        return EOF;
+    }
+
+    if (endian == BF_LITTLE_ENDIAN)
+    {
+        return GetBitsLE(bits, count);
+    }
+    else if (endian == BF_BIG_ENDIAN)
+    {
+        return GetBitsBE(bits, count, size);
+    }
+
+    throw("Error: System Endianess Unknown");
+}
+
+/***************************************************************************
+*   Method     : GetBitsLE   (Little Endian)
+*   Description: This method reads the specified number of bits from the
+*                cursor and writes them to the requested memory location.
+*                Bits are read LSB to MSB.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*   Effects    : Advances the cursor.  bits is treated as a little endian
+*                integer of length >= (count/8) + 1.
+*   Returned   : EOF for failure, otherwise the number of bits read.
+***************************************************************************/
+int bit_cursor_c::GetBitsLE(void *bits, const unsigned int count)
+{
+    unsigned char *bytes;
+    unsigned int offset, remaining;
+    int returnValue;
+
+    bytes = (unsigned char *)bits;
+    offset = 0;
+    remaining = count;
+
+    /* read whole bytes */
+    while (remaining >= 8)
+    {
+        returnValue = GetChar();
+
+        if (returnValue == EOF)
+        {
+            return EOF;
+        }
+
+        bytes[offset] = (unsigned char)returnValue;
+        remaining -= 8;
+        offset++;
+    }
+
+    if (remaining != 0)
+    {
+        /* shift remaining bits into the partial byte */
+        if (m_BitCount < remaining)
+        {
+            Fill();
+
+            if (m_BitCount < remaining)
+            {
+                return EOF;
+            }
+        }
+
+        m_BitCount -= remaining;
+        bytes[offset] = (unsigned char)((bytes[offset] << remaining) |
+            ((m_BitBuffer >> m_BitCount) & (0xFF >> (8 - remaining))));
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : GetBitsBE   (Big Endian)
+*   Description: This method reads the specified number of bits from the
+*                cursor and writes them to the requested memory location.
+*                Bits are read LSB to MSB.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*                size - sizeof type containing "bits"
+*   Effects    : Advances the cursor.  bits is treated as a big endian
+*                integer of length size.
+*   Returned   : EOF for failure, otherwise the number of bits read.
+***************************************************************************/
+int bit_cursor_c::GetBitsBE(void *bits, const unsigned int count,
+    const size_t size)
+{
+    unsigned char *bytes;
+    int offset, returnValue;
+    unsigned int remaining;
+
+    if (count > (size * 8))
+    {
+        /* too many bits to read */
+        return EOF;
+    }
+
+    bytes = (unsigned char *)bits;
+    offset = size - 1;
+    remaining = count;
+
+    /* read whole bytes */
+    while (remaining >= 8)
+    {
+        returnValue = GetChar();
+
+        if (returnValue == EOF)
+        {
+            return EOF;
+        }
+
+        bytes[offset] = (unsigned char)returnValue;
+        remaining -= 8;
+        offset--;
+    }
+
+    if (remaining != 0)
+    {
+        /* shift remaining bits into the partial byte */
+        if (m_BitCount < remaining)
+        {
+            Fill();
+
+            if (m_BitCount < remaining)
+            {
+                return EOF;
+            }
+        }
+
+        m_BitCount -= remaining;
+        bytes[offset] = (unsigned char)((bytes[offset] << remaining) |
+            ((m_BitBuffer >> m_BitCount) & (0xFF >> (8 - remaining))));
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : eof
+*   Description: This method indicates whether or not the cursor has read
+*                every bit.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Returns true if there are no bits left to read.
+***************************************************************************/
+bool bit_cursor_c::eof(void) const
+{
+    return ((m_BitCount == 0) && (m_Next >= m_Size));
+}
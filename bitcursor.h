@@ -0,0 +1,133 @@
+/***************************************************************************
+*                  Shared Bit File Mapping and Cursor Header
+*
+*   File    : bitcursor.h
+*   Purpose : Provides definitions and prototypes for a read-only memory
+*             mapping of a bit file that may be shared by many threads, and
+*             for lightweight cursors that read bits from the mapping.  A
+*             cursor holds only a bit position and an accumulator, so each
+*             thread may create as many cursors as it needs without locks.
+*             Cursor methods are analogous to the bit_file_c read methods.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITCURSOR_H
+#define __BITCURSOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* expected access pattern of a mapping (see bit_mapping_c::Advise) */
+typedef enum
+{
+    BF_ACCESS_NORMAL,
+    BF_ACCESS_SEQUENTIAL,       /* read front to back, ahead of cursors */
+    BF_ACCESS_RANDOM            /* rank/select style lookups */
+} BF_ACCESS;
+
+/* read-only mapping of an entire file.  const methods are thread safe. */
+class bit_mapping_c
+{
+    public:
+        bit_mapping_c(void);
+        bit_mapping_c(const char *fileName);
+        virtual ~bit_mapping_c(void);
+
+        /* map/unmap file */
+        void Open(const char *fileName);
+        void Close(void);
+
+        /* tell the kernel how the mapping will be read */
+        int Advise(const BF_ACCESS access) const;
+        int WillNeed(const uint64_t bitOffset, const uint64_t count) const;
+
+        /* mapped bytes and their sizes */
+        const unsigned char *Data(void) const;
+        uint64_t Size(void) const;
+        uint64_t Bits(void) const;
+
+    private:
+        unsigned char *m_Data;          /* mapped file, NULL if none */
+        uint64_t m_Size;                /* size of mapped file in bytes */
+
+        /* mappings may not be copied */
+        bit_mapping_c(const bit_mapping_c &);
+        bit_mapping_c &operator=(const bit_mapping_c &);
+};
+
+/* independent read position in a mapping or other read-only memory */
+class bit_cursor_c
+{
+    public:
+        bit_cursor_c(void);
+        bit_cursor_c(const bit_mapping_c &mapping,
+            const uint64_t bitOffset = 0);
+        bit_cursor_c(const void *data, const uint64_t size,
+            const uint64_t bitOffset = 0);
+
+        /* bit position of next bit to read */
+        int Seek(const uint64_t bitOffset);
+        uint64_t Tell(void) const;
+
+        /* bits left to read */
+        uint64_t Remaining(void) const;
+
+        /* toss spare bits and byte align cursor */
+        int ByteAlign(void);
+
+        /* get character */
+        int GetChar(void);
+
+        /* get single bit */
+        int GetBit(void);
+
+        /* get number of bits */
+        int64_t GetBits(void *bits, const uint64_t count);
+
+        /* get number of bits into integer types (short, int, ...) */
+        int GetBitsInt(void *bits, const unsigned int count,
+            const size_t size);
+
+        /* status */
+        bool eof(void) const;
+
+    private:
+        const unsigned char *m_Data;    /* bytes being read */
+        uint64_t m_Size;                /* number of bytes in m_Data */
+        uint64_t m_Next;                /* next byte to load into buffer */
+        uint64_t m_BitBuffer;           /* bits waiting to be read */
+        unsigned char m_BitCount;       /* number of bits in bitBuffer */
+
+        void Fill(void);
+        int GetBitsLE(void *bits, const unsigned int count);
+        int GetBitsBE(void *bits, const unsigned int count,
+            const size_t size);
+};
+
+#endif  /* ndef __BITCURSOR_H */
@@ -0,0 +1,137 @@
+/***************************************************************************
+*                    Bit Stream Comparison Implementation
+*
+*   File    : bitdiff.cpp
+*   Purpose : This file implements CompareBits, which compares two bit
+*             streams a block at a time.  Each cursor shifts its block
+*             into byte alignment as it reads it, so the streams may start
+*             at different bit offsets; the blocks are then compared with
+*             the fastest xor and population count kernel the processor
+*             supports.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include "bitdiff.h"
+#include "bitcpu.h"
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* bytes compared per block */
+#define BITDIFF_BLOCK   16384
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : CompareBits
+*   Description: This function compares the next count bits of two
+*                cursors and reports how many differ and where the first
+*                difference is.  If either cursor has fewer than count
+*                bits left, the bits both have are compared.
+*   Parameters : a - cursor for the first stream
+*                b - cursor for the second stream
+*                count - number of bits to compare
+*                result - where to store the result
+*   Effects    : Advances both cursors past the bits compared.
+*   Returned   : EOF if either stream ended before count bits (result
+*                still describes the bits compared), otherwise the number
+*                of bits that differ.
+***************************************************************************/
+int64_t CompareBits(bit_cursor_c &a, bit_cursor_c &b, const uint64_t count,
+    bf_compare_t *result)
+{
+    unsigned char blockA[BITDIFF_BLOCK], blockB[BITDIFF_BLOCK];
+    const bf_cpu_kernels_t *kernels;
+    uint64_t limit, done, length;
+
+    if (result == NULL)
+    {
+        return EOF;
+    }
+
+    kernels = BitCpuKernels();
+    result->compared = 0;
+    result->differences = 0;
+    result->first = BF_NO_DIFFERENCE;
+
+    limit = count;
+
+    if (limit > a.Remaining())
+    {
+        limit = a.Remaining();
+    }
+
+    if (limit > b.Remaining())
+    {
+        limit = b.Remaining();
+    }
+
+    for (done = 0; done < limit; done += length)
+    {
+        uint64_t differences;
+        size_t first;
+
+        length = limit - done;
+
+        if (length > (8 * sizeof(blockA)))
+        {
+            length = 8 * sizeof(blockA);
+        }
+
+        /* the bits after a partial last byte are read as 0 in both */
+        if ((a.GetBits(blockA, length) == EOF) ||
+            (b.GetBits(blockB, length) == EOF))
+        {
+            return EOF;
+        }
+
+        differences = kernels->DiffBits(blockA, blockB, (length + 7) / 8,
+            &first);
+
+        if ((differences != 0) && (BF_NO_DIFFERENCE == result->first))
+        {
+            unsigned int x = blockA[first] ^ blockB[first];
+
+            result->first = done + (8 * first) +
+                (unsigned int)(__builtin_clz(x) - 24);
+        }
+
+        result->differences += differences;
+        result->compared += length;
+    }
+
+    if (limit != count)
+    {
+        return EOF;
+    }
+
+    return (int64_t)result->differences;
+}
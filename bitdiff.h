@@ -0,0 +1,65 @@
+/***************************************************************************
+*                       Bit Stream Comparison Header
+*
+*   File    : bitdiff.h
+*   Purpose : Provides definitions and prototypes for comparing two bit
+*             streams read through bit_cursor_c objects.  The streams do
+*             not need to start at the same bit alignment.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITDIFF_H
+#define __BITDIFF_H
+
+#include <stdint.h>
+#include "bitcursor.h"
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+/* bf_compare_t first when no bits differ */
+#define BF_NO_DIFFERENCE    UINT64_MAX
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef struct
+{
+    uint64_t compared;          /* number of bits compared */
+    uint64_t differences;       /* number of those bits that differ */
+    uint64_t first;             /* offset of first difference from where
+                                   the comparison started, or
+                                   BF_NO_DIFFERENCE */
+} bf_compare_t;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* compare count bits from each cursor; returns differences or EOF */
+int64_t CompareBits(bit_cursor_c &a, bit_cursor_c &b, const uint64_t count,
+    bf_compare_t *result);
+
+#endif  /* ndef __BITDIFF_H */
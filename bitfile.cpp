@@ -84,10 +84,63 @@
 /***************************************************************************
 *                             INCLUDED FILES
 ***************************************************************************/
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <new>
 #include "bitfile.h"
+#include "crc32c.h"
+#include "bitcpu.h"
+#include "bitcommit.h"
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 using namespace std;
 
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* m_FdState bits for compact mode files */
+#define BF_FD_EOF       0x01
+#define BF_FD_ERROR     0x02
+
+/* m_Options bits */
+#define BF_OPT_CHECKSUM 0x01
+
+/* bytes shifted at a time by PutBits when not byte aligned */
+#define BF_BULK_BLOCK   4096
+
+/* most bytes passed to a single read/write call */
+#define BF_BULK_MAX     ((uint64_t)1 << 30)
+
+/* smallest run of zero bytes PutZeros leaves as a hole */
+#define BF_HOLE_MIN     65536
+
+/* compact mode buffers this large are backed by huge pages */
+#define BF_HUGE_PAGE    ((size_t)2 << 20)
+#define BF_HUGE_ROUND(n)    (((size_t)(n) + BF_HUGE_PAGE - 1) & \
+    ~(BF_HUGE_PAGE - 1))
+
+/* most fragments passed to a single writev call */
+#define BF_IOV_MAX      64
+
+/* longest LEB128 encoding of a 64 bit value */
+#define BF_VARINT_MAX   10
+
+/* zigzag map signed values to unsigned so small magnitudes stay short */
+#define ZIGZAG_ENCODE(v)    (((uint64_t)(v) << 1) ^ (uint64_t)((v) >> 63))
+#define ZIGZAG_DECODE(u)    ((int64_t)((u) >> 1) ^ -(int64_t)((u) & 1))
+
 /***************************************************************************
 *                            TYPE DEFINITIONS
 ***************************************************************************/
@@ -120,6 +173,21 @@ bit_file_c::bit_file_c(void)
     m_BitCount = 0;
     m_Mode = BF_NO_MODE;
 
+    m_Fd = -1;
+    m_Buffer = NULL;
+    m_BufferSize = 0;
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_FilePos = 0;
+    m_FdState = 0;
+    m_Options = 0;
+    m_Crc = 0;
+    m_CrcPos = 0;
+    m_CrcStart = 0;
+    m_Kernels = BitCpuKernels();
+    m_Durability = BF_DURABLE_NONE;
+    m_Committer = NULL;
+
     /* test for endianess */
     endian_test_t endianTest;
 
@@ -161,6 +229,22 @@ bit_file_c::bit_file_c(const char *fileName, const BF_MODES mode)
     m_OutStream = NULL;
     m_BitBuffer = 0;
     m_BitCount = 0;
+    m_Mode = BF_NO_MODE;
+
+    m_Fd = -1;
+    m_Buffer = NULL;
+    m_BufferSize = 0;
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_FilePos = 0;
+    m_FdState = 0;
+    m_Options = 0;
+    m_Crc = 0;
+    m_CrcPos = 0;
+    m_CrcStart = 0;
+    m_Kernels = BitCpuKernels();
+    m_Durability = BF_DURABLE_NONE;
+    m_Committer = NULL;
 
     switch (mode)
     {
@@ -240,36 +324,81 @@ bit_file_c::bit_file_c(const char *fileName, const BF_MODES mode)
 }
 
 /***************************************************************************
-*   Method     : ~bit_file_c - destructor
-*   Description: This is the bit_file_c destructor.  It closes and frees
-*                any open file streams.  The bit buffer will be flushed
-*                prior to closing an output stream.
-*   Parameters : None
-*   Effects    : Closes and frees open file streams.
+*   Method     : bit_file_c - constructor
+*   Description: This is a bit_file_c constructor for compact mode files.
+*                It opens a file descriptor for input or output and clears
+*                the bit buffer.  An exception will be thrown on error.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the file to be opened.
+*                mode - The mode of the file to be opened
+*                bufferSize - size of the on demand I/O buffer (0 for
+*                             unbuffered)
+*   Effects    : Initializes private members.  Opens a file descriptor.
 *   Returned   : None
+*   Exception  : "Error: Invalid File Type" - for unknown mode
+*                "Error: Unable To Open File" - if file cannot be opened
 ***************************************************************************/
-bit_file_c::~bit_file_c(void)
+bit_file_c::bit_file_c(const char *fileName, const BF_MODES mode,
+    const unsigned int bufferSize)
 {
-    if (m_InStream != NULL)
+    m_InStream = NULL;
+    m_OutStream = NULL;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+    m_Mode = BF_NO_MODE;
+
+    m_Fd = -1;
+    m_Buffer = NULL;
+    m_BufferSize = 0;
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_FilePos = 0;
+    m_FdState = 0;
+    m_Options = 0;
+    m_Crc = 0;
+    m_CrcPos = 0;
+    m_CrcStart = 0;
+    m_Kernels = BitCpuKernels();
+    m_Durability = BF_DURABLE_NONE;
+    m_Committer = NULL;
+
+    OpenFd(fileName, mode, bufferSize);
+
+    /* test for endianess */
+    endian_test_t endianTest;
+
+    endianTest.word = 1;
+
+    if (endianTest.bytes[0] == 1)
     {
-        m_InStream->close();
-        delete m_InStream;
+        /* LSB is 1st byte (little endian)*/
+        m_endian = BF_LITTLE_ENDIAN;
     }
-
-    if (m_OutStream != NULL)
+    else if (endianTest.bytes[sizeof(unsigned long) - 1] == 1)
     {
-        /* write out any unwritten bits */
-        if (m_BitCount != 0)
-        {
-            m_BitBuffer <<= (8 - m_BitCount);
-            m_OutStream->put(m_BitBuffer);
-        }
-
-        m_OutStream->close();
-        delete m_OutStream;
+        /* LSB is last byte (big endian)*/
+        m_endian = BF_BIG_ENDIAN;
+    }
+    else
+    {
+        m_endian = BF_UNKNOWN_ENDIAN;
     }
 }
 
+/***************************************************************************
+*   Method     : ~bit_file_c - destructor
+*   Description: This is the bit_file_c destructor.  It closes and frees
+*                any open file streams or descriptors.  The bit buffer will
+*                be flushed prior to closing an output file.
+*   Parameters : None
+*   Effects    : Closes and frees open file streams and descriptors.
+*   Returned   : None
+***************************************************************************/
+bit_file_c::~bit_file_c(void)
+{
+    Close();
+}
+
 /***************************************************************************
 *   Method     : Open
 *   Description: This method opens an input or output stream and initializes
@@ -286,7 +415,7 @@ bit_file_c::~bit_file_c(void)
 void bit_file_c::Open(const char *fileName, const BF_MODES mode)
 {
     /* make sure file isn't already open */
-    if ((m_InStream != NULL) || (m_OutStream != NULL))
+    if ((m_InStream != NULL) || (m_OutStream != NULL) || (m_Fd >= 0))
     {
         throw("Error: File Already Open");
     }
@@ -357,6 +486,113 @@ void bit_file_c::Open(const char *fileName, const BF_MODES mode)
     }
 }
 
+/***************************************************************************
+*   Method     : Open
+*   Description: This method opens a compact mode file.  Compact mode files
+*                use a file descriptor instead of a file stream and only
+*                allocate their I/O buffer while it holds data, so an idle
+*                open file costs little more than the object itself.  An
+*                exception will be thrown on error.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the file to be opened.
+*                mode - The mode of the file to be opened
+*                bufferSize - size of the on demand I/O buffer (0 for
+*                             unbuffered)
+*   Effects    : Opens a file descriptor and initializes the bit buffer.
+*   Returned   : None
+*   Exception  : "Error: File Already Open" - if object has an open file
+*                "Error: Invalid File Type" - for unknown mode
+*                "Error: Unable To Open File" - if file cannot be opened
+***************************************************************************/
+void bit_file_c::Open(const char *fileName, const BF_MODES mode,
+    const unsigned int bufferSize)
+{
+    /* make sure file isn't already open */
+    if ((m_InStream != NULL) || (m_OutStream != NULL) || (m_Fd >= 0))
+    {
+        throw("Error: File Already Open");
+    }
+
+    OpenFd(fileName, mode, bufferSize);
+}
+
+/***************************************************************************
+*   Method     : OpenFd
+*   Description: This method opens the file descriptor used by compact mode
+*                files.  No buffer is allocated until the first read or
+*                write.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the file to be opened.
+*                mode - The mode of the file to be opened
+*                bufferSize - size of the on demand I/O buffer
+*   Effects    : Opens a file descriptor and initializes the bit buffer.
+*   Returned   : None
+*   Exception  : "Error: Invalid File Type" - for unknown mode
+*                "Error: Unable To Open File" - if file cannot be opened
+***************************************************************************/
+void bit_file_c::OpenFd(const char *fileName, const BF_MODES mode,
+    const unsigned int bufferSize)
+{
+    int flags;
+
+    switch (mode)
+    {
+        case BF_READ:
+            flags = O_RDONLY;
+            break;
+
+        case BF_WRITE:
+            flags = O_RDWR | O_CREAT | O_TRUNC;
+            break;
+
+        case BF_APPEND:
+            flags = O_RDWR | O_CREAT | O_APPEND;
+            break;
+
+        default:
+            throw("Error: Invalid File Type");
+            break;
+    }
+
+    /* writers are opened read/write so PatchBits can read back bytes */
+    m_Fd = open(fileName, flags, 0666);
+
+    if ((m_Fd < 0) && (EACCES == errno) && (flags & O_RDWR))
+    {
+        flags = (flags & ~O_RDWR) | O_WRONLY;
+        m_Fd = open(fileName, flags, 0666);
+    }
+
+    if (m_Fd < 0)
+    {
+        throw("Error: Unable To Open File");
+    }
+
+    m_Mode = mode;
+    m_Buffer = NULL;
+    m_BufferSize = bufferSize;
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_FilePos = 0;
+    m_FdState = 0;
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    if (BF_READ == mode)
+    {
+        /* bit files are read front to back; ask for deeper read ahead */
+        posix_fadvise(m_Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+
+    if (BF_APPEND == mode)
+    {
+        off_t end = lseek(m_Fd, 0, SEEK_END);
+        m_FilePos = (end < 0) ? 0 : (uint64_t)end;
+    }
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+}
+
 /***************************************************************************
 *   Method     : Close
 *   Description: This method closes and frees any open file streams.  The
@@ -397,6 +633,216 @@ void bit_file_c::Close(void)
         m_BitCount = 0;
         m_Mode = BF_NO_MODE;
     }
+
+    m_Options = 0;
+    m_Crc = 0;
+    m_CrcPos = 0;
+    m_CrcStart = 0;
+
+    if (m_Fd >= 0)
+    {
+        if (IsWriting())
+        {
+            /* write out any unwritten bits */
+            if (m_BitCount != 0)
+            {
+                m_BitBuffer <<= (8 - m_BitCount);
+                WriteByte(m_BitBuffer);
+            }
+
+            FlushBuffer();
+            SyncOutput();
+        }
+
+        close(m_Fd);
+        FreeBuffer();
+
+        m_Fd = -1;
+        m_Buffer = NULL;
+        m_BufferSize = 0;
+        m_BufferPos = 0;
+        m_BufferLen = 0;
+        m_FilePos = 0;
+        m_FdState = 0;
+        m_BitBuffer = 0;
+        m_BitCount = 0;
+        m_Mode = BF_NO_MODE;
+    }
+
+    m_Durability = BF_DURABLE_NONE;
+    m_Committer = NULL;
+}
+
+/***************************************************************************
+*   Method     : ReleaseBuffer
+*   Description: This method frees the I/O buffer of a compact mode file
+*                that is going idle.  Buffered output is written to the
+*                file and unread input is given back by seeking the file
+*                descriptor backwards.  A new buffer will be allocated by
+*                the next read or write.  Partial byte bits are kept in
+*                the bit buffer.
+*   Parameters : None
+*   Effects    : Flushes or rewinds buffered data and frees the buffer.
+*   Returned   : EOF if this isn't a compact mode file or the flush/seek
+*                fails.  Otherwise 0.
+***************************************************************************/
+int bit_file_c::ReleaseBuffer(void)
+{
+    if (m_Fd < 0)
+    {
+        return EOF;
+    }
+
+    if (IsWriting())
+    {
+        if (FlushBuffer() == EOF)
+        {
+            return EOF;
+        }
+    }
+    else if (m_BufferPos < m_BufferLen)
+    {
+        UpdateChecksum();
+
+        /* give back read ahead bytes */
+        if (lseek(m_Fd, -(off_t)(m_BufferLen - m_BufferPos), SEEK_CUR) < 0)
+        {
+            return EOF;
+        }
+
+        m_FilePos += m_BufferPos;
+    }
+    else
+    {
+        UpdateChecksum();
+        m_FilePos += m_BufferPos;
+    }
+
+    FreeBuffer();
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_CrcPos = 0;
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Fill
+*   Description: This method tops off the input buffer of a compact mode
+*                file with a single read of the file descriptor.  Unread
+*                bytes are moved to the front of the buffer first.  Reads
+*                that find an empty buffer refill it on their own, but
+*                calling Fill ahead of time lets the bit level methods run
+*                entirely from memory, and lets the blocking read be done
+*                somewhere else (see bitfile_async.h).
+*   Parameters : None
+*   Effects    : Reads from the file descriptor into the buffer.
+*   Returned   : EOF if this isn't a buffered compact mode input file or
+*                the read fails.  Otherwise the number of bytes read (0 at
+*                the end of the file or when the buffer is already full).
+***************************************************************************/
+int bit_file_c::Fill(void)
+{
+    unsigned int unread;
+    ssize_t result;
+
+    if ((m_Fd < 0) || (BF_READ != m_Mode) || (0 == m_BufferSize))
+    {
+        return EOF;
+    }
+
+    if (m_FdState & BF_FD_ERROR)
+    {
+        return EOF;
+    }
+
+    if (NULL == m_Buffer)
+    {
+        /* allocate buffer on demand */
+        AllocBuffer();
+    }
+
+    /* keep the unread bytes */
+    UpdateChecksum();
+    unread = m_BufferLen - m_BufferPos;
+    memmove(m_Buffer, m_Buffer + m_BufferPos, unread);
+    m_FilePos += m_BufferPos;
+    m_BufferPos = 0;
+    m_BufferLen = unread;
+    m_CrcPos = 0;
+
+    if (unread == m_BufferSize)
+    {
+        return 0;
+    }
+
+    while ((result = read(m_Fd, m_Buffer + unread, m_BufferSize - unread)) <
+        0)
+    {
+        if (errno != EINTR)
+        {
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+    }
+
+    /* EOF is left for a read that finds the buffer empty */
+    m_BufferLen += (unsigned int)result;
+    return (int)result;
+}
+
+/***************************************************************************
+*   Method     : Drain
+*   Description: This method writes all buffered output bytes to the file.
+*                Bits in a partial byte stay in the bit buffer.  Writes
+*                that find a full buffer drain it on their own, but calling
+*                Drain lets the blocking write be done somewhere else (see
+*                bitfile_async.h).
+*   Parameters : None
+*   Effects    : Writes the compact mode buffer to the file descriptor, or
+*                flushes the output stream.
+*   Returned   : EOF if the file isn't writable or the write fails.
+*                Otherwise 0.
+***************************************************************************/
+int bit_file_c::Drain(void)
+{
+    if (m_OutStream != NULL)
+    {
+        m_OutStream->flush();
+        return (m_OutStream->bad() ? EOF : 0);
+    }
+
+    if ((m_Fd < 0) || (BF_READ == m_Mode))
+    {
+        return EOF;
+    }
+
+    return FlushBuffer();
+}
+
+/***************************************************************************
+*   Method     : Buffered
+*   Description: This method returns the number of bytes held in a compact
+*                mode buffer.  For input files these are bytes that can be
+*                read without touching the file.  For output files these
+*                are bytes waiting to be written.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of buffered bytes.  0 for stream mode files.
+***************************************************************************/
+unsigned int bit_file_c::Buffered(void) const
+{
+    if (m_Fd < 0)
+    {
+        return 0;
+    }
+
+    if (BF_READ == m_Mode)
+    {
+        return m_BufferLen - m_BufferPos;
+    }
+
+    return m_BufferPos;
 }
 
 /***************************************************************************
@@ -417,14 +863,14 @@ int bit_file_c::ByteAlign(void)
 
     if ((BF_WRITE == m_Mode) || (BF_APPEND == m_Mode))
     {
-        if (NULL == m_OutStream)
+        if (!IsWriting())
         {
             return(EOF);
         }
     }
     else
     {
-        if (NULL == m_InStream)
+        if (!IsReading())
         {
             return(EOF);
         }
@@ -438,7 +884,7 @@ int bit_file_c::ByteAlign(void)
         if (m_BitCount != 0)
         {
             m_BitBuffer <<= 8 - (m_BitCount);
-            m_OutStream->put(m_BitBuffer);  /* check for error */
+            WriteByte(m_BitBuffer);  /* check for error */
         }
     }
 
@@ -452,18 +898,21 @@ int bit_file_c::ByteAlign(void)
 *   Method     : FlushOutput
 *   Description: This method flushes the output bit buffer.  This means
 *                left justifying any pending bits, and filling spare bits
-*                with the fill value.
+*                with the fill value.  If a durability other than
+*                BF_DURABLE_NONE is set, everything written is then synced
+*                or registered for the next group commit.
 *   Parameters : onesFill - non-zero if spare bits are filled with ones
 *   Effects    : Flushes out the bit buffer, filling spare bits with ones
 *                or zeros.
-*   Returned   : EOF if stream is NULL or not writeable.  Otherwise, the
-*                bit buffer value written. -1 if no data was written.
+*   Returned   : EOF if stream is NULL or not writeable, or the sync
+*                fails.  Otherwise, the bit buffer value written. -1 if no
+*                data was written.
 ***************************************************************************/
 int bit_file_c::FlushOutput(const unsigned char onesFill)
 {
     int returnValue;
 
-    if (NULL == m_OutStream)
+    if (!IsWriting())
     {
         return(EOF);
     }
@@ -480,13 +929,18 @@ int bit_file_c::FlushOutput(const unsigned char onesFill)
             m_BitBuffer |= (0xFF >> m_BitCount);
         }
 
-        m_OutStream->put(m_BitBuffer);      /* check for error */
+        WriteByte(m_BitBuffer);      /* check for error */
         returnValue = m_BitBuffer;
     }
 
     m_BitBuffer = 0;
     m_BitCount = 0;
 
+    if (SyncOutput() == EOF)
+    {
+        return EOF;
+    }
+
     return (returnValue);
 }
 
@@ -502,19 +956,19 @@ int bit_file_c::GetChar(void)
 {
     int returnValue, tmp;
 
-    if (m_InStream == NULL)
+    if (!IsReading())
     {
         return EOF;
     }
 
-    if (m_InStream->eof())
+    if (this->eof())
     {
         return EOF;
     }
 
-    returnValue = m_InStream->get();
+    returnValue = ReadByte();
 
-    if (m_BitCount == 0)
+    if ((m_BitCount == 0) || (returnValue == EOF))
     {
         /* we can just get byte from file */
         return returnValue;
@@ -538,13 +992,13 @@ int bit_file_c::GetChar(void)
 *                output stream.
 *   Parameters : c - the character to be written
 *   Effects    : Writes a byte to the file and updates buffer accordingly.
-*   Returned   : On success, the character written, otherwise EOF.
+*   Returned   : On success, the byte written (0 - 255), otherwise EOF.
 ***************************************************************************/
 int bit_file_c::PutChar(const int c)
 {
     int tmp;
 
-    if (m_OutStream == NULL)
+    if (!IsWriting())
     {
         return EOF;
     }
@@ -552,36 +1006,40 @@ int bit_file_c::PutChar(const int c)
     if (m_BitCount == 0)
     {
         /* we can just put byte from file */
-        m_OutStream->put(c);
-        return c;
+        return WriteByte(c);
     }
 
     /* figure out what to write */
     tmp = (c & 0xFF) >> m_BitCount;
     tmp = tmp | ((m_BitBuffer) << (8 - m_BitCount));
 
-    m_OutStream->put((char)tmp);    /* check for error */
+    if (WriteByte(tmp) == EOF)
+    {
+        return EOF;
+    }
 
     /* put remaining in buffer. count shouldn't change. */
     m_BitBuffer = (char)c;
 
-    return tmp;
+    return (tmp & 0xFF);
 }
 
 /***************************************************************************
-*   Method     : GetBit
+*   Method     : GetBitRefill
 *   Description: This method returns the next bit from the input stream.
-*                The bit value returned is the msb in the bit buffer.
+*                The bit value returned is the msb in the bit buffer.  It
+*                is the out of line part of GetBit (see bitfile.h), called
+*                when the bit buffer is empty.
 *   Parameters : None
 *   Effects    : Reads next bit from bit buffer.  If the buffer is empty,
 *                a new byte will be read from the input stream.
 *   Returned   : 0 if bit == 0, 1 if bit == 1, and EOF if operation fails.
 ***************************************************************************/
-int bit_file_c::GetBit(void)
+int bit_file_c::GetBitRefill(void)
 {
     int returnValue;
 
-    if (m_InStream == NULL)
+    if (!IsReading())
     {
         return EOF;
     }
@@ -589,7 +1047,7 @@ int bit_file_c::GetBit(void)
     if (m_BitCount == 0)
     {
         /* buffer is empty, read another character */
-        if ((returnValue = m_InStream->get()) == EOF)
+        if ((returnValue = ReadByte()) == EOF)
         {
             return EOF;         /* nothing left to read */
         }
@@ -608,19 +1066,20 @@ int bit_file_c::GetBit(void)
 }
 
 /***************************************************************************
-*   Method     : PutBit
+*   Method     : PutBitFlush
 *   Description: This method writes the bit passed as a parameter to the
-*                output stream.
+*                output stream.  It is the out of line part of PutBit (see
+*                bitfile.h), called when the bit completes a byte.
 *   Parameters : c - the bit value to be written
 *   Effects    : Writes a bit to the bit buffer.  If the buffer has a byte,
 *                the buffer is written to the output stream and cleared.
 *   Returned   : On success, the bit value written, otherwise EOF.
 ***************************************************************************/
-int bit_file_c::PutBit(const int c)
+int bit_file_c::PutBitFlush(const int c)
 {
     int returnValue = c;
 
-    if (m_OutStream == NULL)
+    if (!IsWriting())
     {
         return EOF;
     }
@@ -636,7 +1095,7 @@ int bit_file_c::PutBit(const int c)
     /* write bit buffer if we have 8 bits */
     if (m_BitCount == 8)
     {
-        m_OutStream->put(m_BitBuffer);    /* check for error */
+        WriteByte(m_BitBuffer);    /* check for error */
 
         /* reset buffer */
         m_BitCount = 0;
@@ -650,7 +1109,9 @@ int bit_file_c::PutBit(const int c)
 *   Method     : GetBits
 *   Description: This method reads the specified number of bits from the
 *                input stream and writes them to the requested memory
-*                location (msb to lsb).
+*                location (msb to lsb).  Whole bytes are read in bulk and,
+*                if the file isn't byte aligned, shifted into place
+*                afterwards.
 *   Parameters : bits - address to store bits read
 *                count - number of bits to read
 *   Effects    : Reads bits from the bit buffer and file stream.  The bit
@@ -659,39 +1120,56 @@ int bit_file_c::PutBit(const int c)
 *                an EOF is reached before all the bits are read, bits
 *                will contain every bit through the last complete byte.
 ***************************************************************************/
-int bit_file_c::GetBits(void *bits, const unsigned int count)
+int64_t bit_file_c::GetBits(void *bits, const uint64_t count)
 {
-    char *bytes, shifts;
-    int offset, remaining, returnValue;
+    unsigned char *bytes, shifts;
+    uint64_t offset, remaining;
+    int returnValue;
 
-    if ((m_InStream == NULL) || (bits == NULL))
+    if ((!IsReading()) || (bits == NULL))
     {
         return EOF;
     }
 
-    bytes = (char *)bits;
+    bytes = (unsigned char *)bits;
 
-    offset = 0;
-    remaining = count;
+    offset = count / 8;
+    remaining = count % 8;
 
     /* read whole bytes */
-    while (remaining >= 8)
+    if (offset != 0)
     {
-        returnValue = this->GetChar();
+        uint64_t got;
 
-        if (returnValue == EOF)
+        if (this->eof())
         {
             return EOF;
         }
 
-        bytes[offset] = (char)returnValue;
-        remaining -= 8;
-        offset++;
-    }
+        got = ReadBytes(bytes, offset);
 
-    if (remaining != 0)
-    {
-        /* read remaining bits */
+        if (m_BitCount != 0)
+        {
+            /* shift the bytes read into place behind the buffered bits */
+            if (got != 0)
+            {
+                unsigned char last = bytes[got - 1];
+
+                m_Kernels->ShiftBytes(bytes, bytes, got, m_BitCount,
+                    (unsigned char)m_BitBuffer);
+                m_BitBuffer = (char)last;
+            }
+        }
+
+        if (got != offset)
+        {
+            return EOF;
+        }
+    }
+
+    if (remaining != 0)
+    {
+        /* read remaining bits */
         shifts = 8 - remaining;
 
         while (remaining > 0)
@@ -712,14 +1190,16 @@ int bit_file_c::GetBits(void *bits, const unsigned int count)
         bytes[offset] <<= shifts;
     }
 
-    return count;
+    return (int64_t)count;
 }
 
 /***************************************************************************
 *   Method     : PutBits
 *   Description: This method writes the specified number of bits from the
 *                memory location passed as a parameter to the output
-*                stream.   Bits are written msb to lsb.
+*                stream.   Bits are written msb to lsb.  Whole bytes are
+*                written in bulk; if the file isn't byte aligned they are
+*                shifted a block at a time first.
 *   Parameters : bits - pointer to bits to write
 *                count - number of bits to write
 *   Effects    : Writes bits to the bit buffer and file stream.  The bit
@@ -728,33 +1208,54 @@ int bit_file_c::GetBits(void *bits, const unsigned int count)
 *                an error occurs after a partial write, the partially
 *                written bits will not be unwritten.
 ***************************************************************************/
-int bit_file_c::PutBits(void *bits, const unsigned int count)
+int64_t bit_file_c::PutBits(void *bits, const uint64_t count)
 {
-    char *bytes, tmp;
-    int offset, remaining, returnValue;
+    unsigned char *bytes, tmp;
+    uint64_t offset, remaining;
+    int returnValue;
 
-    if ((m_OutStream == NULL) || (bits == NULL))
+    if ((!IsWriting()) || (bits == NULL))
     {
         return EOF;
     }
 
-    bytes = (char *)bits;
+    bytes = (unsigned char *)bits;
 
-    offset = 0;
-    remaining = count;
+    offset = count / 8;
+    remaining = count % 8;
 
     /* write whole bytes */
-    while (remaining >= 8)
+    if (0 == m_BitCount)
     {
-        returnValue = this->PutChar(bytes[offset]);
-
-        if (returnValue == EOF)
+        if (WriteBytes(bytes, offset) == EOF)
         {
             return EOF;
         }
+    }
+    else
+    {
+        unsigned char block[BF_BULK_BLOCK];
+        uint64_t done, length;
 
-        remaining -= 8;
-        offset++;
+        for (done = 0; done < offset; done += length)
+        {
+            length = offset - done;
+
+            if (length > sizeof(block))
+            {
+                length = sizeof(block);
+            }
+
+            m_Kernels->ShiftBytes(block, bytes + done, length, m_BitCount,
+                (unsigned char)m_BitBuffer);
+
+            if (WriteBytes(block, length) == EOF)
+            {
+                return EOF;
+            }
+
+            m_BitBuffer = (char)bytes[done + length - 1];
+        }
     }
 
     if (remaining != 0)
@@ -775,7 +1276,381 @@ int bit_file_c::PutBits(void *bits, const unsigned int count)
         }
     }
 
-    return count;
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : PutZeros
+*   Description: This method writes a run of 0 bits.  When a compact mode
+*                file is byte aligned at its end, a large run isn't written
+*                at all; the file is extended with ftruncate, leaving a
+*                sparse hole that reads back as zeros.
+*   Parameters : count - number of 0 bits to write
+*   Effects    : Writes count 0 bits.
+*   Returned   : EOF for failure, otherwise the number of bits written.
+***************************************************************************/
+int64_t bit_file_c::PutZeros(const uint64_t count)
+{
+    uint64_t remaining;
+
+    if (!IsWriting())
+    {
+        return EOF;
+    }
+
+    remaining = count;
+
+    /* fill out the partial byte */
+    while ((m_BitCount != 0) && (remaining != 0))
+    {
+        if (PutBit(0) == EOF)
+        {
+            return EOF;
+        }
+
+        remaining--;
+    }
+
+    if ((remaining / 8 >= BF_HOLE_MIN) && SkipZeros(remaining / 8))
+    {
+        remaining %= 8;
+    }
+
+    if (PutPattern(0, 64, remaining) == EOF)
+    {
+        return EOF;
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : PutOnes
+*   Description: This method writes a run of 1 bits.
+*   Parameters : count - number of 1 bits to write
+*   Effects    : Writes count 1 bits.
+*   Returned   : EOF for failure, otherwise the number of bits written.
+***************************************************************************/
+int64_t bit_file_c::PutOnes(const uint64_t count)
+{
+    return PutPattern(~(uint64_t)0, 64, count);
+}
+
+/***************************************************************************
+*   Method     : PutPattern
+*   Description: This method writes count bits made by repeating the low
+*                period bits of pattern (msb first).  A block holding a
+*                whole number of repetitions is built once and written
+*                with PutBits until the run is done.
+*   Parameters : pattern - the bits to repeat, right justified
+*                period - number of bits in the pattern (1 - 64)
+*                count - number of bits to write (the last repetition may
+*                        be cut short)
+*   Effects    : Writes count bits.
+*   Returned   : EOF for failure, otherwise the number of bits written.
+***************************************************************************/
+int64_t bit_file_c::PutPattern(const uint64_t pattern,
+    const unsigned int period, const uint64_t count)
+{
+    unsigned char block[BF_BULK_BLOCK];
+    uint64_t remaining, length;
+    unsigned int bytes, bit, i;
+
+    if ((!IsWriting()) || (period < 1) || (period > 64))
+    {
+        return EOF;
+    }
+
+    /* period bytes hold 8 repetitions, so the block ends on a repetition */
+    bytes = (sizeof(block) / period) * period;
+
+    if ((uint64_t)bytes * 8 > count)
+    {
+        /* only build what's needed */
+        bytes = (unsigned int)((count + 7) / 8);
+    }
+
+    bit = 0;
+
+    for (i = 0; i < bytes; i++)
+    {
+        unsigned char byte = 0;
+        int j;
+
+        for (j = 0; j < 8; j++)
+        {
+            byte = (byte << 1) | ((pattern >> (period - 1 - bit)) & 0x01);
+            bit = (bit + 1 == period) ? 0 : bit + 1;
+        }
+
+        block[i] = byte;
+    }
+
+    for (remaining = count; remaining != 0; remaining -= length)
+    {
+        length = (remaining < (uint64_t)bytes * 8) ? remaining :
+            (uint64_t)bytes * 8;
+
+        if (PutBits(block, length) == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : GetBitsAsBytes
+*   Description: This method reads the specified number of bits and
+*                stores each one as a byte that is 0 or 1.  Bits are read
+*                a block at a time with GetBits and expanded with the
+*                fastest kernel the processor supports.
+*   Parameters : out - where to store count bytes
+*                count - number of bits to read
+*   Effects    : Reads bits from the bit buffer and file stream.
+*   Returned   : EOF for failure, otherwise the number of bits read.  If
+*                an EOF is reached before all the bits are read, out will
+*                contain every bit of the blocks read before the last one.
+***************************************************************************/
+int64_t bit_file_c::GetBitsAsBytes(uint8_t *out, const uint64_t count)
+{
+    unsigned char block[BF_BULK_BLOCK];
+    uint64_t done, length;
+
+    if ((!IsReading()) || (out == NULL))
+    {
+        return EOF;
+    }
+
+    for (done = 0; done < count; done += length)
+    {
+        length = count - done;
+
+        if (length > (8 * sizeof(block)))
+        {
+            length = 8 * sizeof(block);
+        }
+
+        if (GetBits(block, length) == EOF)
+        {
+            return EOF;
+        }
+
+        m_Kernels->ExpandBits(out + done, block, length / 8);
+
+        if ((length % 8) != 0)
+        {
+            /* only the last block can end in a partial byte */
+            uint8_t last[8];
+
+            m_Kernels->ExpandBits(last, block + (length / 8), 1);
+            memcpy(out + done + (length & ~(uint64_t)7), last, length % 8);
+        }
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : PutBitsFromBytes
+*   Description: This method writes one bit for each of the specified
+*                number of bytes; a byte that isn't 0 is a 1 bit.  Bytes
+*                are packed a block at a time with the fastest kernel the
+*                processor supports and written with PutBits.
+*   Parameters : in - count bytes to write as bits
+*                count - number of bits to write
+*   Effects    : Writes bits to the bit buffer and file stream.
+*   Returned   : EOF for failure, otherwise the number of bits written.  If
+*                an error occurs after a partial write, the partially
+*                written bits will not be unwritten.
+***************************************************************************/
+int64_t bit_file_c::PutBitsFromBytes(const uint8_t *in, const uint64_t count)
+{
+    unsigned char block[BF_BULK_BLOCK];
+    uint64_t done, length;
+
+    if ((!IsWriting()) || (in == NULL))
+    {
+        return EOF;
+    }
+
+    for (done = 0; done < count; done += length)
+    {
+        length = count - done;
+
+        if (length > (8 * sizeof(block)))
+        {
+            length = 8 * sizeof(block);
+        }
+
+        m_Kernels->CompressBits(block, in + done, length / 8);
+
+        if ((length % 8) != 0)
+        {
+            /* only the last block can end in a partial byte */
+            uint8_t last[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+            memcpy(last, in + done + (length & ~(uint64_t)7), length % 8);
+            m_Kernels->CompressBits(block + (length / 8), last, 1);
+        }
+
+        if (PutBits(block, length) == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : PutBitsV
+*   Description: This method writes a list of fragments, as if PutBits
+*                were called for each one.  When a compact mode file is
+*                byte aligned, runs of whole byte fragments too large for
+*                the buffer are handed to writev as they are, without being
+*                copied into one buffer first.
+*   Parameters : vec - array of fragments
+*                n - number of fragments in vec
+*   Effects    : Writes bits to the bit buffer and file.
+*   Returned   : EOF for failure, otherwise the number of bits written.  If
+*                an error occurs after a partial write, the partially
+*                written bits will not be unwritten.
+***************************************************************************/
+int64_t bit_file_c::PutBitsV(const bf_iovec_t *vec, const size_t n)
+{
+    uint64_t total, bytes;
+    size_t i, j;
+
+    if ((!IsWriting()) || ((vec == NULL) && (n != 0)))
+    {
+        return EOF;
+    }
+
+    total = 0;
+    i = 0;
+
+    while (i < n)
+    {
+        if ((m_Fd >= 0) && (0 == m_BitCount))
+        {
+            /* longest run of whole byte fragments */
+            bytes = 0;
+
+            for (j = i; (j < n) && (j - i < BF_IOV_MAX) &&
+                ((vec[j].count % 8) == 0); j++)
+            {
+                bytes += vec[j].count / 8;
+            }
+
+            if ((j - i > 1) && (m_BufferPos + bytes > m_BufferSize))
+            {
+                if (WriteFragments(vec + i, j - i, bytes) == EOF)
+                {
+                    return EOF;
+                }
+
+                total += 8 * bytes;
+                i = j;
+                continue;
+            }
+        }
+
+        if (PutBits((void *)vec[i].bits, vec[i].count) == EOF)
+        {
+            return EOF;
+        }
+
+        total += vec[i].count;
+        i++;
+    }
+
+    return (int64_t)total;
+}
+
+/***************************************************************************
+*   Method     : CopyBits
+*   Description: This static method copies bits from a file open for
+*                reading to a file open for writing.  When both are
+*                compact mode files, both are byte aligned, and neither
+*                keeps a checksum, the data is copied by the kernel with
+*                copy_file_range or sendfile and never enters this process.
+*                Otherwise the bits go through GetBits and PutBits a block
+*                at a time.
+*   Parameters : reader - bit file open for reading
+*                writer - bit file open for writing
+*                count - number of bits to copy
+*   Effects    : Reads count bits from reader and writes them to writer.
+*   Returned   : EOF for failure, otherwise the number of bits copied.  If
+*                an EOF is reached before all the bits are read, some of
+*                the bits that were read may not have been written.
+***************************************************************************/
+int64_t bit_file_c::CopyBits(bit_file_c &reader, bit_file_c &writer,
+    const uint64_t count)
+{
+    unsigned char block[BF_BULK_BLOCK];
+    uint64_t done, length;
+
+    if ((!reader.IsReading()) || (!writer.IsWriting()))
+    {
+        return EOF;
+    }
+
+    done = 0;
+
+#if defined(__linux__)
+    if ((reader.m_Fd >= 0) && (writer.m_Fd >= 0) &&
+        (0 == reader.m_BitCount) && (0 == writer.m_BitCount) &&
+        (0 == ((reader.m_Options | writer.m_Options) & BF_OPT_CHECKSUM)) &&
+        (count / 8 >= BF_BULK_BLOCK))
+    {
+        /* hand over what the reader has already buffered */
+        length = reader.m_BufferLen - reader.m_BufferPos;
+
+        if (length > count / 8)
+        {
+            length = count / 8;
+        }
+
+        if (writer.WriteBytes(reader.m_Buffer + reader.m_BufferPos,
+            length) == EOF)
+        {
+            return EOF;
+        }
+
+        reader.m_BufferPos += (unsigned int)length;
+
+        if ((writer.m_BufferPos != 0) && (writer.FlushBuffer() == EOF))
+        {
+            return EOF;
+        }
+
+        length += reader.KernelCopy(writer, (count / 8) - length);
+        done = length * 8;
+    }
+#endif
+
+    /* whatever the kernel didn't copy */
+    while (done < count)
+    {
+        length = count - done;
+
+        if (length > 8 * sizeof(block))
+        {
+            length = 8 * sizeof(block);
+        }
+
+        if ((reader.GetBits(block, length) == EOF) ||
+            (writer.PutBits(block, length) == EOF))
+        {
+            return EOF;
+        }
+
+        done += length;
+    }
+
+    return (int64_t)count;
 }
 
 /***************************************************************************
@@ -800,7 +1675,7 @@ int bit_file_c::GetBitsInt(void *bits, const unsigned int count,
 {
     int returnValue;
 
-    if ((m_InStream == NULL) || (bits == NULL))
+    if ((!IsReading()) || (bits == NULL))
     {
         return EOF;
     }
@@ -840,7 +1715,7 @@ int bit_file_c::GetBitsLE(void *bits, const unsigned int count)
     char *bytes;
     int offset, remaining, returnValue;
 
-    if ((m_InStream == NULL) || (bits == NULL))
+    if ((!IsReading()) || (bits == NULL))
     {
         return EOF;
     }
@@ -977,7 +1852,7 @@ int bit_file_c::PutBitsInt(void *bits, const unsigned int count,
 {
     int returnValue;
 
-    if ((m_OutStream == NULL) || (bits == NULL))
+    if ((!IsWriting()) || (bits == NULL))
     {
         return EOF;
     }
@@ -1126,74 +2001,2111 @@ int bit_file_c::PutBitsBE(void *bits, const unsigned int count,
 }
 
 /***************************************************************************
-*   Method     : eof
-*   Description: This method indicates whether or not the open file stream
-*                is at the end of file.
-*   Parameters : None
-*   Effects    : None
-*   Returned   : Returns true if the opened file stream is at an EOF.
-*                Otherwise false is returned.
+*   Method     : GetVarint
+*   Description: This method reads an unsigned LEB128 varint.  Each byte
+*                holds 7 value bits, least significant group first, with
+*                the msb set on every byte but the last.  The bytes are
+*                read with GetChar, so the varint does not have to be byte
+*                aligned.
+*   Parameters : value - address to store the value read
+*   Effects    : Reads 1 to 10 bytes worth of bits.
+*   Returned   : EOF if the file ends, the encoding is longer than 10
+*                bytes, or the value doesn't fit in 64 bits.  Otherwise the
+*                number of bytes read.
 ***************************************************************************/
-bool bit_file_c::eof(void)
+int bit_file_c::GetVarint(uint64_t *value)
 {
-    if (m_InStream != NULL)
+    uint64_t result;
+    int c, i;
+
+    if ((!IsReading()) || (value == NULL))
     {
-        return (m_InStream->eof());
+        return EOF;
     }
 
-    if (m_OutStream != NULL)
+    result = 0;
+
+    for (i = 0; i < BF_VARINT_MAX; i++)
     {
-        return (m_OutStream->eof());
+        if ((c = GetChar()) == EOF)
+        {
+            return EOF;
+        }
+
+        if ((9 == i) && (c > 1))
+        {
+            /* more than 64 bits */
+            return EOF;
+        }
+
+        result |= (uint64_t)(c & 0x7F) << (7 * i);
+
+        if (!(c & 0x80))
+        {
+            *value = result;
+            return (i + 1);
+        }
     }
 
-    /* return false for no file */
-    return false;
+    return EOF;
 }
 
 /***************************************************************************
-*   Method     : good
-*   Description: This method is analogous to good for file streams.
+*   Method     : PutVarint
+*   Description: This method writes an unsigned LEB128 varint (see
+*                GetVarint) at the current bit position.
+*   Parameters : value - the value to write
+*   Effects    : Writes 1 to 10 bytes worth of bits.
+*   Returned   : EOF for failure, otherwise the number of bytes written.
+***************************************************************************/
+int bit_file_c::PutVarint(const uint64_t value)
+{
+    unsigned char bytes[BF_VARINT_MAX];
+    uint64_t remaining;
+    int length, i;
+
+    if (!IsWriting())
+    {
+        return EOF;
+    }
+
+    remaining = value;
+    length = 0;
+
+    while (remaining >= 0x80)
+    {
+        bytes[length++] = (unsigned char)(remaining | 0x80);
+        remaining >>= 7;
+    }
+
+    bytes[length++] = (unsigned char)remaining;
+
+    for (i = 0; i < length; i++)
+    {
+        if (PutChar(bytes[i]) == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    return length;
+}
+
+/***************************************************************************
+*   Method     : GetVarintSigned
+*   Description: This method reads a zigzag encoded signed LEB128 varint.
+*                Zigzag encoding maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ...
+*   Parameters : value - address to store the value read
+*   Effects    : Reads 1 to 10 bytes worth of bits.
+*   Returned   : EOF for failure, otherwise the number of bytes read.
+***************************************************************************/
+int bit_file_c::GetVarintSigned(int64_t *value)
+{
+    uint64_t zigzag;
+    int returnValue;
+
+    if (value == NULL)
+    {
+        return EOF;
+    }
+
+    returnValue = GetVarint(&zigzag);
+
+    if (returnValue != EOF)
+    {
+        *value = ZIGZAG_DECODE(zigzag);
+    }
+
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : PutVarintSigned
+*   Description: This method writes a zigzag encoded signed LEB128 varint
+*                (see GetVarintSigned).
+*   Parameters : value - the value to write
+*   Effects    : Writes 1 to 10 bytes worth of bits.
+*   Returned   : EOF for failure, otherwise the number of bytes written.
+***************************************************************************/
+int bit_file_c::PutVarintSigned(const int64_t value)
+{
+    return PutVarint(ZIGZAG_ENCODE(value));
+}
+
+/***************************************************************************
+*   Method     : GetVarints
+*   Description: This method reads an array of unsigned LEB128 varints.
+*                When a compact mode file is byte aligned, the varints are
+*                decoded straight out of the buffer.  Runs of single byte
+*                varints are found 16 at a time with SSE2, and longer ones
+*                are decoded a 64 bit word at a time.  Other files are read
+*                with GetVarint.
+*   Parameters : values - array to store the values read
+*                count - number of values to read
+*   Effects    : Reads count varints.
+*   Returned   : EOF if no values could be read, otherwise the number of
+*                values read (less than count if an error occurs).
+***************************************************************************/
+int64_t bit_file_c::GetVarints(uint64_t *values, const size_t count)
+{
+    size_t done;
+
+    if ((!IsReading()) || (values == NULL))
+    {
+        return EOF;
+    }
+
+    done = 0;
+
+    while (done < count)
+    {
+        if ((0 == m_BitCount) && (m_BufferLen - m_BufferPos >= 16))
+        {
+            const unsigned char *in = m_Buffer + m_BufferPos;
+            const unsigned char *end = m_Buffer + m_BufferLen - 16;
+
+            /* decode while a whole word can be loaded */
+            while ((done < count) && (in <= end))
+            {
+#if defined(__SSE2__)
+                if (count - done >= 16)
+                {
+                    __m128i block = _mm_loadu_si128((const __m128i *)in);
+
+                    if (0 == _mm_movemask_epi8(block))
+                    {
+                        /* 16 single byte varints */
+                        int j;
+
+                        for (j = 0; j < 16; j++)
+                        {
+                            values[done + j] = in[j];
+                        }
+
+                        done += 16;
+                        in += 16;
+                        continue;
+                    }
+                }
+#endif
+                uint64_t word, stops;
+                unsigned int length;
+                int j;
+
+                word = 0;
+
+                for (j = 7; j >= 0; j--)
+                {
+                    word = (word << 8) | in[j];
+                }
+
+                stops = ~word & 0x8080808080808080ULL;
+
+                if (0 == stops)
+                {
+                    /* longer than 8 bytes, take the slow path */
+                    break;
+                }
+
+                length = (__builtin_ctzll(stops) / 8) + 1;
+
+                if (length < 8)
+                {
+                    word &= ((uint64_t)1 << (length * 8)) - 1;
+                }
+
+                /* squeeze out the continuation bits */
+                values[done++] = (word & 0x7F) |
+                    ((word >> 1) & (0x7FULL << 7)) |
+                    ((word >> 2) & (0x7FULL << 14)) |
+                    ((word >> 3) & (0x7FULL << 21)) |
+                    ((word >> 4) & (0x7FULL << 28)) |
+                    ((word >> 5) & (0x7FULL << 35)) |
+                    ((word >> 6) & (0x7FULL << 42)) |
+                    ((word >> 7) & (0x7FULL << 49));
+                in += length;
+            }
+
+            m_BufferPos = (unsigned int)(in - m_Buffer);
+
+            if (done == count)
+            {
+                break;
+            }
+        }
+
+        /* buffer nearly empty, not aligned, or a long varint */
+        if (GetVarint(values + done) == EOF)
+        {
+            return (0 == done) ? EOF : (int64_t)done;
+        }
+
+        done++;
+    }
+
+    return (int64_t)done;
+}
+
+/***************************************************************************
+*   Method     : PutVarints
+*   Description: This method writes an array of unsigned LEB128 varints.
+*                When a compact mode file is byte aligned, the varints are
+*                encoded straight into the buffer.
+*   Parameters : values - array of values to write
+*                count - number of values to write
+*   Effects    : Writes count varints.
+*   Returned   : EOF if no values could be written, otherwise the number of
+*                values written (less than count if an error occurs).
+***************************************************************************/
+int64_t bit_file_c::PutVarints(const uint64_t *values, const size_t count)
+{
+    size_t done;
+
+    if ((!IsWriting()) || (values == NULL))
+    {
+        return EOF;
+    }
+
+    done = 0;
+
+    while (done < count)
+    {
+        if ((0 == m_BitCount) && (m_Buffer != NULL) &&
+            (m_BufferSize - m_BufferPos >= BF_VARINT_MAX))
+        {
+            unsigned char *out = m_Buffer + m_BufferPos;
+            unsigned char *end = m_Buffer + m_BufferSize - BF_VARINT_MAX;
+
+            while ((done < count) && (out <= end))
+            {
+                uint64_t remaining = values[done++];
+
+                while (remaining >= 0x80)
+                {
+                    *out++ = (unsigned char)(remaining | 0x80);
+                    remaining >>= 7;
+                }
+
+                *out++ = (unsigned char)remaining;
+            }
+
+            m_BufferPos = (unsigned int)(out - m_Buffer);
+
+            if (done == count)
+            {
+                break;
+            }
+        }
+
+        /* buffer nearly full or not aligned */
+        if (PutVarint(values[done]) == EOF)
+        {
+            return (0 == done) ? EOF : (int64_t)done;
+        }
+
+        done++;
+    }
+
+    return (int64_t)done;
+}
+
+/***************************************************************************
+*   Method     : GetVarintsSigned
+*   Description: This method reads an array of zigzag encoded signed LEB128
+*                varints.
+*   Parameters : values - array to store the values read
+*                count - number of values to read
+*   Effects    : Reads count varints.
+*   Returned   : EOF if no values could be read, otherwise the number of
+*                values read.
+***************************************************************************/
+int64_t bit_file_c::GetVarintsSigned(int64_t *values, const size_t count)
+{
+    int64_t returnValue, i;
+
+    returnValue = GetVarints((uint64_t *)values, count);
+
+    for (i = 0; i < returnValue; i++)
+    {
+        uint64_t zigzag = (uint64_t)values[i];
+        values[i] = ZIGZAG_DECODE(zigzag);
+    }
+
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : PutVarintsSigned
+*   Description: This method writes an array of zigzag encoded signed
+*                LEB128 varints.
+*   Parameters : values - array of values to write
+*                count - number of values to write
+*   Effects    : Writes count varints.
+*   Returned   : EOF if no values could be written, otherwise the number of
+*                values written.
+***************************************************************************/
+int64_t bit_file_c::PutVarintsSigned(const int64_t *values, const size_t count)
+{
+    uint64_t zigzag[64];
+    size_t done, chunk, i;
+    int64_t returnValue;
+
+    if (values == NULL)
+    {
+        return EOF;
+    }
+
+    /* zigzag encode in chunks and write them with PutVarints */
+    for (done = 0; done < count; done += chunk)
+    {
+        chunk = count - done;
+
+        if (chunk > 64)
+        {
+            chunk = 64;
+        }
+
+        for (i = 0; i < chunk; i++)
+        {
+            zigzag[i] = ZIGZAG_ENCODE(values[done + i]);
+        }
+
+        returnValue = PutVarints(zigzag, chunk);
+
+        if (returnValue != (int64_t)chunk)
+        {
+            if (returnValue == EOF)
+            {
+                return (0 == done) ? EOF : (int64_t)done;
+            }
+
+            return (int64_t)done + returnValue;
+        }
+    }
+
+    return (int64_t)done;
+}
+
+/***************************************************************************
+*   Method     : FindNextSet
+*   Description: This method skips 0 bits until the next 1 bit, leaving
+*                the 1 bit as the next bit to be read.
 *   Parameters : None
-*   Effects    : None
-*   Returned   : Returns good for the opened file stream.  False is
-*                returned if there is no open file stream.
+*   Effects    : Reads past the 0 bits.
+*   Returned   : EOF if no 1 bit is found, otherwise the number of 0 bits
+*                skipped.
 ***************************************************************************/
-bool bit_file_c::good(void)
+int64_t bit_file_c::FindNextSet(void)
 {
-    if (m_InStream != NULL)
+    uint64_t run;
+    bool stopped;
+
+    if (!IsReading())
     {
-        return (m_InStream->good());
+        return EOF;
     }
 
-    if (m_OutStream != NULL)
+    run = SkipRun(0, ~(uint64_t)0, &stopped);
+    return stopped ? (int64_t)run : EOF;
+}
+
+/***************************************************************************
+*   Method     : FindNextClear
+*   Description: This method skips 1 bits until the next 0 bit, leaving
+*                the 0 bit as the next bit to be read.
+*   Parameters : None
+*   Effects    : Reads past the 1 bits.
+*   Returned   : EOF if no 0 bit is found, otherwise the number of 1 bits
+*                skipped.
+***************************************************************************/
+int64_t bit_file_c::FindNextClear(void)
+{
+    uint64_t run;
+    bool stopped;
+
+    if (!IsReading())
     {
-        return (m_OutStream->good());
+        return EOF;
     }
 
-    /* return false for no file */
-    return false;
+    run = SkipRun(1, ~(uint64_t)0, &stopped);
+    return stopped ? (int64_t)run : EOF;
 }
 
 /***************************************************************************
-*   Method     : bad
-*   Description: This method is analogous to bad for file streams.
+*   Method     : CountRun
+*   Description: This method reads bits for as long as they equal bitValue,
+*                up to max bits.  The first bit that differs is left to be
+*                read next.
+*   Parameters : bitValue - the value (0 or 1) of the bits in the run
+*                max - most bits to read
+*   Effects    : Reads past the run.
+*   Returned   : EOF if the file isn't open for reading, otherwise the
+*                length of the run (0 if the next bit differs or at end
+*                of file).
+***************************************************************************/
+int64_t bit_file_c::CountRun(const int bitValue, const uint64_t max)
+{
+    bool stopped;
+
+    if (!IsReading())
+    {
+        return EOF;
+    }
+
+    return (int64_t)SkipRun((bitValue != 0), max, &stopped);
+}
+
+/***************************************************************************
+*   Method     : Tell
+*   Description: This method returns the current bit position in the file.
+*                For input files this is the position of the next bit to be
+*                read.  For output files it is the position the next bit
+*                will be written to, including bits in the bit buffer.
 *   Parameters : None
 *   Effects    : None
-*   Returned   : Returns bad for the opened file stream.  False is
-*                returned if there is no open file stream.
+*   Returned   : The bit offset from the start of the file.  0 if no file
+*                is open or an input stream can't report its position.
 ***************************************************************************/
-bool bit_file_c::bad(void)
+uint64_t bit_file_c::Tell(void)
 {
-    if (m_InStream != NULL)
+    uint64_t bytes;
+
+    if (m_Fd >= 0)
     {
-        return (m_InStream->bad());
+        bytes = m_FilePos + m_BufferPos;
     }
+    else if (m_InStream != NULL)
+    {
+        /* tellg fails once a read hits EOF, so clear that state first */
+        ios::iostate state = m_InStream->rdstate();
+        streampos pos;
 
-    if (m_OutStream != NULL)
+        m_InStream->clear(state & ios::badbit);
+        pos = m_InStream->tellg();
+        m_InStream->clear(state);
+
+        if (pos < 0)
+        {
+            return 0;
+        }
+
+        bytes = (uint64_t)pos;
+    }
+    else if (m_OutStream != NULL)
     {
-        return (m_OutStream->bad());
+        bytes = (uint64_t)m_OutStream->tellp();
+    }
+    else
+    {
+        return 0;
     }
 
-    /* return false for no file */
-    return false;
+    if (IsReading())
+    {
+        return (bytes * 8) - m_BitCount;
+    }
+
+    return (bytes * 8) + m_BitCount;
+}
+
+/***************************************************************************
+*   Method     : ReserveBits
+*   Description: This method writes count zero bits that will be filled in
+*                later with PatchBits, for things like length fields that
+*                precede the data they describe.
+*   Parameters : count - number of bits to reserve (64 or fewer)
+*                reservation - handle to pass to PatchBits
+*   Effects    : Writes count zero bits.
+*   Returned   : EOF for failure, otherwise the number of bits reserved.
+***************************************************************************/
+int bit_file_c::ReserveBits(const unsigned int count,
+    bf_reservation_t *reservation)
+{
+    unsigned char zeros[8];
+
+    if ((!IsWriting()) || (reservation == NULL) || (count > 64))
+    {
+        return EOF;
+    }
+
+    reservation->offset = Tell();
+    reservation->count = count;
+
+    memset(zeros, 0, sizeof(zeros));
+    return (int)PutBits(zeros, count);
+}
+
+/***************************************************************************
+*   Method     : PatchBits
+*   Description: This method overwrites bits set aside by ReserveBits.  Bits
+*                still in the bit buffer or in a compact mode output buffer
+*                are changed in memory.  Bits that have already been
+*                written to a compact mode file are changed with
+*                pread/pwrite.  Stream mode files can only be patched while
+*                the bits are in the bit buffer.  If a running checksum
+*                already includes the patched bytes, it is corrected.
+*   Parameters : reservation - handle returned by ReserveBits
+*                value - the new bits, right justified (the last
+*                        reservation->count bits of value are used).
+*   Effects    : Changes previously written bits.
+*   Returned   : EOF for failure, otherwise the number of bits patched.
+***************************************************************************/
+int bit_file_c::PatchBits(const bf_reservation_t *reservation,
+    const uint64_t value)
+{
+    unsigned char masks[9], bits[9];
+    uint64_t offset, first, pending, byte;
+    unsigned int count, bytes, i, k;
+
+    if ((!IsWriting()) || (reservation == NULL) ||
+        (reservation->count > 64))
+    {
+        return EOF;
+    }
+
+    offset = reservation->offset;
+    count = reservation->count;
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    if (offset + count > Tell())
+    {
+        /* reservation hasn't been written */
+        return EOF;
+    }
+
+    /* masks and values of the bits to change in each byte */
+    first = offset / 8;
+    bytes = (unsigned int)(((offset + count + 7) / 8) - first);
+    memset(masks, 0, sizeof(masks));
+    memset(bits, 0, sizeof(bits));
+
+    for (i = 0; i < count; i++)
+    {
+        k = (unsigned int)(((offset + i) / 8) - first);
+        masks[k] |= 0x80 >> ((offset + i) % 8);
+
+        if ((value >> (count - 1 - i)) & 1)
+        {
+            bits[k] |= 0x80 >> ((offset + i) % 8);
+        }
+    }
+
+    /* index of the byte being assembled in the bit buffer */
+    pending = (Tell() - m_BitCount) / 8;
+
+    if ((m_Fd < 0) && (first < pending))
+    {
+        /* bytes handed to a stream can't be changed */
+        return EOF;
+    }
+
+    k = 0;
+
+    if ((m_Fd >= 0) && (first < m_FilePos))
+    {
+        /* already written to the file */
+        k = (unsigned int)(m_FilePos - first);
+
+        if (k > bytes)
+        {
+            k = bytes;
+        }
+
+        if (PatchFile(first, masks, bits, k) == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    for (; k < bytes; k++)
+    {
+        byte = first + k;
+
+        if (byte == pending)
+        {
+            /* the bit buffer holds the msbs of this byte */
+            unsigned char shift = 8 - m_BitCount;
+
+            m_BitBuffer = (char)((m_BitBuffer & ~(masks[k] >> shift)) |
+                (bits[k] >> shift));
+        }
+        else
+        {
+            /* in the compact mode buffer */
+            unsigned int index = (unsigned int)(byte - m_FilePos);
+            unsigned char old = m_Buffer[index];
+
+            m_Buffer[index] = (old & ~masks[k]) | bits[k];
+
+            if ((m_Options & BF_OPT_CHECKSUM) && (index < m_CrcPos) &&
+                (byte >= m_CrcStart))
+            {
+                unsigned char delta = old ^ m_Buffer[index];
+
+                m_Crc = Crc32cAdjust(m_Crc, &delta, 1,
+                    m_CrcPos - index - 1);
+            }
+        }
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : SetChecksum
+*   Description: This method starts or stops computing a running CRC-32C of
+*                the bytes read from or written to the file.  Starting the
+*                checksum clears it, so only bytes transferred after the
+*                call are included.  Starting the checksum byte aligns the
+*                file first, so a writer and a reader that start it at the
+*                same bit position cover the same bytes.  A partially
+*                written byte is written out with zeros in its spare bits,
+*                and the rest of a partially read byte is discarded; that
+*                byte isn't included in the checksum.
+*   Parameters : enable - true to start computing the checksum, false to
+*                         stop.
+*   Effects    : Byte aligns the file if enable is true.  Clears the
+*                checksum and changes the checksum option.
+*   Returned   : EOF if byte aligning leaves the file bad (the partial
+*                byte couldn't be written), otherwise 0.  The checksum
+*                isn't started or stopped on failure.
+***************************************************************************/
+int bit_file_c::SetChecksum(const bool enable)
+{
+    if (enable && (m_BitCount != 0))
+    {
+        /* ByteAlign returns the old bit buffer, so check the file */
+        ByteAlign();
+
+        if (bad())
+        {
+            return EOF;
+        }
+    }
+
+    m_Crc = 0;
+    m_CrcPos = m_BufferPos;
+    m_CrcStart = m_FilePos + m_BufferPos;
+
+    if (enable)
+    {
+        m_Options |= BF_OPT_CHECKSUM;
+    }
+    else
+    {
+        m_Options &= ~BF_OPT_CHECKSUM;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Checksum
+*   Description: This method returns the CRC-32C of the bytes read or
+*                written since the checksum was enabled.
+*   Parameters : None
+*   Effects    : Adds any buffered bytes that haven't been included to the
+*                checksum.
+*   Returned   : The CRC-32C of the bytes transferred.
+***************************************************************************/
+uint32_t bit_file_c::Checksum(void)
+{
+    UpdateChecksum();
+    return m_Crc;
+}
+
+/***************************************************************************
+*   Method     : PutChecksum
+*   Description: This method byte aligns an output file, filling spare bits
+*                with zeros, and appends the 4 byte checksum trailer (most
+*                significant byte first).  The trailer itself is not added
+*                to the running checksum.
+*   Parameters : None
+*   Effects    : Flushes out the bit buffer and writes 4 bytes.
+*   Returned   : EOF if the file isn't writable, the checksum isn't enabled,
+*                or a write fails.  Otherwise 0.
+***************************************************************************/
+int bit_file_c::PutChecksum(void)
+{
+    uint32_t crc;
+    int i;
+
+    if ((!IsWriting()) || (!(m_Options & BF_OPT_CHECKSUM)))
+    {
+        return EOF;
+    }
+
+    FlushOutput(0);
+    crc = Checksum();
+
+    for (i = 24; i >= 0; i -= 8)
+    {
+        if (WriteByte((crc >> i) & 0xFF) == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    /* exclude the trailer from the checksum */
+    m_Crc = crc;
+    m_CrcPos = m_BufferPos;
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : SaveState
+*   Description: This method checkpoints a compact mode writer.  Buffered
+*                bytes are written (and synced or registered, depending on
+*                the durability) so the file holds every whole byte, and
+*                the bits of the partial byte and the checksum state are
+*                saved with the file length.  After a crash, open the file
+*                with BF_APPEND and call RestoreState to truncate it back
+*                to the checkpoint and continue writing bit for bit where
+*                the checkpoint was taken.
+*   Parameters : state - where to save the writer state
+*   Effects    : Flushes the buffer.
+*   Returned   : EOF if this isn't a compact mode writer or the flush
+*                fails, otherwise 0.
+***************************************************************************/
+int bit_file_c::SaveState(bf_state_t *state)
+{
+    if ((m_Fd < 0) || (!IsWriting()) || (state == NULL))
+    {
+        return EOF;
+    }
+
+    if ((FlushBuffer() == EOF) || (SyncOutput() == EOF))
+    {
+        return EOF;
+    }
+
+    state->bytes = m_FilePos;
+    state->bitCount = m_BitCount;
+    state->bitBuffer = (uint8_t)m_BitBuffer & (0xFF >> (8 - m_BitCount));
+    state->checksum = (m_Options & BF_OPT_CHECKSUM) ? 1 : 0;
+    state->crc = m_Crc;
+    state->crcStart = m_CrcStart;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : RestoreState
+*   Description: This method resumes writing from a checkpoint saved by
+*                SaveState.  The file is truncated to the checkpoint, and
+*                the partial byte bits and checksum state are restored.
+*                Anything written since the file was opened is discarded.
+*   Parameters : state - writer state saved by SaveState
+*   Effects    : Truncates the file and replaces the bit buffer and
+*                checksum state.
+*   Returned   : EOF if this isn't a compact mode file opened with
+*                BF_APPEND, the state is invalid, the file is shorter than
+*                the checkpoint, or it can't be truncated.  Otherwise 0.
+***************************************************************************/
+int bit_file_c::RestoreState(const bf_state_t *state)
+{
+    struct stat status;
+
+    if ((m_Fd < 0) || (BF_APPEND != m_Mode) || (state == NULL) ||
+        (state->bitCount > 7))
+    {
+        return EOF;
+    }
+
+    if ((fstat(m_Fd, &status) != 0) ||
+        ((uint64_t)status.st_size < state->bytes) ||
+        (ftruncate(m_Fd, (off_t)state->bytes) != 0))
+    {
+        return EOF;
+    }
+
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_FilePos = state->bytes;
+    m_FdState = 0;
+    m_BitBuffer = (char)state->bitBuffer;
+    m_BitCount = state->bitCount;
+
+    if (state->checksum)
+    {
+        m_Options |= BF_OPT_CHECKSUM;
+    }
+    else
+    {
+        m_Options &= ~BF_OPT_CHECKSUM;
+    }
+
+    m_Crc = state->crc;
+    m_CrcPos = 0;
+    m_CrcStart = state->crcStart;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : SetDurability
+*   Description: This method sets how the data written to a compact mode
+*                file is made durable when FlushOutput or Close is called.
+*                BF_DURABLE_FLUSH calls fdatasync each time.
+*                BF_DURABLE_GROUP writes the buffer and registers the file
+*                with committer, which syncs the files of many writers
+*                together; call committer->Sync() to wait for them.  Close
+*                resets the durability to BF_DURABLE_NONE.
+*   Parameters : durability - BF_DURABLE_NONE, BF_DURABLE_FLUSH or
+*                             BF_DURABLE_GROUP
+*                committer - group committer for BF_DURABLE_GROUP.  It
+*                            must outlive the file or its Close.
+*   Effects    : Changes the durability.
+*   Returned   : EOF if this isn't a compact mode file or BF_DURABLE_GROUP
+*                is requested without a committer.  Otherwise 0.
+***************************************************************************/
+int bit_file_c::SetDurability(const BF_DURABILITY durability,
+    bit_committer_c *committer)
+{
+    if ((m_Fd < 0) ||
+        ((BF_DURABLE_GROUP == durability) && (committer == NULL)))
+    {
+        return EOF;
+    }
+
+    m_Durability = durability;
+    m_Committer = (BF_DURABLE_GROUP == durability) ? committer : NULL;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : VerifyChecksum
+*   Description: This method byte aligns an input file, discarding spare
+*                bits, reads a 4 byte checksum trailer written by
+*                PutChecksum, and compares it to the running checksum.
+*   Parameters : None
+*   Effects    : Flushes the bit buffer and reads 4 bytes.
+*   Returned   : 1 if the trailer matches, 0 if it doesn't, and EOF if the
+*                file isn't readable, the checksum isn't enabled, or the
+*                trailer can't be read.
+***************************************************************************/
+int bit_file_c::VerifyChecksum(void)
+{
+    uint32_t crc, trailer;
+    int i, c;
+
+    if ((!IsReading()) || (!(m_Options & BF_OPT_CHECKSUM)))
+    {
+        return EOF;
+    }
+
+    ByteAlign();
+    crc = Checksum();
+    trailer = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        if ((c = ReadByte()) == EOF)
+        {
+            return EOF;
+        }
+
+        trailer = (trailer << 8) | (uint32_t)c;
+    }
+
+    /* exclude the trailer from the checksum */
+    m_Crc = crc;
+    m_CrcPos = m_BufferPos;
+
+    return (trailer == crc) ? 1 : 0;
+}
+
+/***************************************************************************
+*   Method     : eof
+*   Description: This method indicates whether or not the open file stream
+*                is at the end of file.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Returns true if the opened file stream or descriptor is
+*                at an EOF.  Otherwise false is returned.
+***************************************************************************/
+bool bit_file_c::eof(void)
+{
+    if (m_InStream != NULL)
+    {
+        return (m_InStream->eof());
+    }
+
+    if (m_OutStream != NULL)
+    {
+        return (m_OutStream->eof());
+    }
+
+    if (m_Fd >= 0)
+    {
+        return ((m_FdState & BF_FD_EOF) != 0);
+    }
+
+    /* return false for no file */
+    return false;
+}
+
+/***************************************************************************
+*   Method     : good
+*   Description: This method is analogous to good for file streams.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Returns good for the opened file stream or descriptor.
+*                False is returned if there is no open file.
+***************************************************************************/
+bool bit_file_c::good(void)
+{
+    if (m_InStream != NULL)
+    {
+        return (m_InStream->good());
+    }
+
+    if (m_OutStream != NULL)
+    {
+        return (m_OutStream->good());
+    }
+
+    if (m_Fd >= 0)
+    {
+        return (m_FdState == 0);
+    }
+
+    /* return false for no file */
+    return false;
+}
+
+/***************************************************************************
+*   Method     : bad
+*   Description: This method is analogous to bad for file streams.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Returns bad for the opened file stream or descriptor.
+*                False is returned if there is no open file.
+***************************************************************************/
+bool bit_file_c::bad(void)
+{
+    if (m_InStream != NULL)
+    {
+        return (m_InStream->bad());
+    }
+
+    if (m_OutStream != NULL)
+    {
+        return (m_OutStream->bad());
+    }
+
+    if (m_Fd >= 0)
+    {
+        return ((m_FdState & BF_FD_ERROR) != 0);
+    }
+
+    /* return false for no file */
+    return false;
+}
+
+/***************************************************************************
+*   Method     : ReadByte
+*   Description: This method reads the next raw byte from the input stream
+*                or compact mode buffer.  It does not touch the bit buffer.
+*   Parameters : None
+*   Effects    : Advances the input stream or buffer by one byte.
+*   Returned   : The byte read (0 - 255) or EOF.
+***************************************************************************/
+int bit_file_c::ReadByte(void)
+{
+    if (m_InStream != NULL)
+    {
+        int c = m_InStream->get();
+
+        if ((m_Options & BF_OPT_CHECKSUM) && (c != EOF))
+        {
+            unsigned char byte = (unsigned char)c;
+            m_Crc = Crc32cUpdate(m_Crc, &byte, 1);
+        }
+
+        return c;
+    }
+
+    if (m_BufferPos < m_BufferLen)
+    {
+        return m_Buffer[m_BufferPos++];
+    }
+
+    return FillBuffer();
+}
+
+/***************************************************************************
+*   Method     : PeekByte
+*   Description: This method returns the next raw byte from the input
+*                stream or compact mode buffer without reading it, so the
+*                next ReadByte returns the same byte.  The byte isn't added
+*                to the checksum until it is read.
+*   Parameters : None
+*   Effects    : May refill the compact mode buffer.
+*   Returned   : The next byte (0 - 255) or EOF.
+***************************************************************************/
+int bit_file_c::PeekByte(void)
+{
+    int c;
+
+    if (m_InStream != NULL)
+    {
+        return m_InStream->peek();
+    }
+
+    if (m_BufferPos < m_BufferLen)
+    {
+        return m_Buffer[m_BufferPos];
+    }
+
+    if ((0 == m_BufferSize) && (m_Fd >= 0) && (0 == m_FdState))
+    {
+        /* unbuffered compact mode: m_FilePos is the descriptor offset */
+        unsigned char byte;
+        ssize_t result;
+
+        while ((result = pread(m_Fd, &byte, 1, (off_t)m_FilePos)) < 0)
+        {
+            if (errno != EINTR)
+            {
+                m_FdState |= BF_FD_ERROR;
+                return EOF;
+            }
+        }
+
+        if (0 == result)
+        {
+            m_FdState |= BF_FD_EOF;
+            return EOF;
+        }
+
+        return byte;
+    }
+
+    /* the refilled byte isn't in the checksum until m_BufferPos passes it */
+    if ((c = FillBuffer()) != EOF)
+    {
+        m_BufferPos--;
+    }
+
+    return c;
+}
+
+/***************************************************************************
+*   Method     : WriteByte
+*   Description: This method writes a raw byte to the output stream or
+*                compact mode buffer.  It does not touch the bit buffer.
+*   Parameters : c - the byte to be written
+*   Effects    : Writes a byte to the output stream or buffer.  A full
+*                buffer is written to the file descriptor first.
+*   Returned   : The byte written or EOF on failure.
+***************************************************************************/
+int bit_file_c::WriteByte(const int c)
+{
+    if (m_OutStream != NULL)
+    {
+        m_OutStream->put((char)c);
+
+        if (m_OutStream->bad())
+        {
+            return EOF;
+        }
+
+        if (m_Options & BF_OPT_CHECKSUM)
+        {
+            unsigned char byte = (unsigned char)c;
+            m_Crc = Crc32cUpdate(m_Crc, &byte, 1);
+        }
+
+        return (c & 0xFF);
+    }
+
+    if (m_BufferPos >= m_BufferSize)
+    {
+        if (0 == m_BufferSize)
+        {
+            /* unbuffered compact mode */
+            unsigned char byte = (unsigned char)c;
+
+            while (write(m_Fd, &byte, 1) != 1)
+            {
+                if (errno != EINTR)
+                {
+                    m_FdState |= BF_FD_ERROR;
+                    return EOF;
+                }
+            }
+
+            if (m_Options & BF_OPT_CHECKSUM)
+            {
+                m_Crc = Crc32cUpdate(m_Crc, &byte, 1);
+            }
+
+            m_FilePos++;
+            return byte;
+        }
+
+        if (FlushBuffer() == EOF)
+        {
+            return EOF;
+        }
+    }
+
+    if (NULL == m_Buffer)
+    {
+        /* allocate buffer on demand */
+        AllocBuffer();
+    }
+
+    m_Buffer[m_BufferPos++] = (unsigned char)c;
+    return (c & 0xFF);
+}
+
+/***************************************************************************
+*   Method     : ReadBytes
+*   Description: This method reads raw bytes in bulk from the input stream
+*                or compact mode buffer.  It does not touch the bit buffer.
+*                Reads at least as large as the compact mode buffer go
+*                straight from the file descriptor into bytes.
+*   Parameters : bytes - address to store bytes read
+*                count - number of bytes to read
+*   Effects    : Advances the input stream or buffer.
+*   Returned   : The number of bytes read, less than count at EOF or on
+*                error.
+***************************************************************************/
+uint64_t bit_file_c::ReadBytes(unsigned char *bytes, const uint64_t count)
+{
+    uint64_t done, length;
+    ssize_t result;
+    int c;
+
+    if (m_InStream != NULL)
+    {
+        done = 0;
+
+        while (done < count)
+        {
+            length = count - done;
+
+            /* streamsize may be narrower than 64 bits */
+            if (length > BF_BULK_MAX)
+            {
+                length = BF_BULK_MAX;
+            }
+
+            m_InStream->read((char *)bytes + done, (streamsize)length);
+            length = (uint64_t)m_InStream->gcount();
+
+            if (m_Options & BF_OPT_CHECKSUM)
+            {
+                m_Crc = Crc32cUpdate(m_Crc, bytes + done, length);
+            }
+
+            done += length;
+
+            if (!m_InStream->good())
+            {
+                break;
+            }
+        }
+
+        return done;
+    }
+
+    done = 0;
+
+    while (done < count)
+    {
+        if (m_BufferPos < m_BufferLen)
+        {
+            /* copy what's buffered */
+            length = m_BufferLen - m_BufferPos;
+
+            if (length > count - done)
+            {
+                length = count - done;
+            }
+
+            memcpy(bytes + done, m_Buffer + m_BufferPos, length);
+            m_BufferPos += (unsigned int)length;
+            done += length;
+        }
+        else if (count - done >= m_BufferSize)
+        {
+            /* bypass the buffer */
+            if ((m_Fd < 0) || (m_FdState != 0))
+            {
+                break;
+            }
+
+            UpdateChecksum();
+            m_FilePos += m_BufferLen;
+            m_BufferPos = 0;
+            m_BufferLen = 0;
+            m_CrcPos = 0;
+
+            length = count - done;
+
+            if (length > BF_BULK_MAX)
+            {
+                length = BF_BULK_MAX;
+            }
+
+            result = read(m_Fd, bytes + done, length);
+
+            if (result < 0)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+
+                m_FdState |= BF_FD_ERROR;
+                break;
+            }
+
+            if (0 == result)
+            {
+                m_FdState |= BF_FD_EOF;
+                break;
+            }
+
+            if (m_Options & BF_OPT_CHECKSUM)
+            {
+                m_Crc = Crc32cUpdate(m_Crc, bytes + done, (size_t)result);
+            }
+
+            m_FilePos += (uint64_t)result;
+            done += (uint64_t)result;
+        }
+        else
+        {
+            /* refill (or unbuffered byte) */
+            if ((c = FillBuffer()) == EOF)
+            {
+                break;
+            }
+
+            bytes[done++] = (unsigned char)c;
+        }
+    }
+
+    return done;
+}
+
+/***************************************************************************
+*   Method     : WriteBytes
+*   Description: This method writes raw bytes in bulk to the output stream
+*                or compact mode buffer.  It does not touch the bit buffer.
+*                Writes that don't fit in the compact mode buffer flush it
+*                and go straight from bytes to the file descriptor.
+*   Parameters : bytes - the bytes to be written
+*                count - number of bytes to write
+*   Effects    : Writes bytes to the output stream or buffer.
+*   Returned   : EOF on failure, otherwise 0.
+***************************************************************************/
+int bit_file_c::WriteBytes(const unsigned char *bytes, const uint64_t count)
+{
+    uint64_t done, length;
+    ssize_t result;
+
+    if (m_OutStream != NULL)
+    {
+        done = 0;
+
+        while (done < count)
+        {
+            length = count - done;
+
+            if (length > BF_BULK_MAX)
+            {
+                length = BF_BULK_MAX;
+            }
+
+            m_OutStream->write((const char *)bytes + done,
+                (streamsize)length);
+
+            if (m_OutStream->bad())
+            {
+                return EOF;
+            }
+
+            if (m_Options & BF_OPT_CHECKSUM)
+            {
+                m_Crc = Crc32cUpdate(m_Crc, bytes + done, length);
+            }
+
+            done += length;
+        }
+
+        return 0;
+    }
+
+    if (m_BufferPos + count <= m_BufferSize)
+    {
+        /* fits in the buffer */
+        if (count != 0)
+        {
+            if (NULL == m_Buffer)
+            {
+                AllocBuffer();
+            }
+
+            memcpy(m_Buffer + m_BufferPos, bytes, count);
+            m_BufferPos += (unsigned int)count;
+        }
+
+        return 0;
+    }
+
+    if ((m_BufferPos != 0) && (FlushBuffer() == EOF))
+    {
+        return EOF;
+    }
+
+    if (count < m_BufferSize)
+    {
+        if (NULL == m_Buffer)
+        {
+            AllocBuffer();
+        }
+
+        memcpy(m_Buffer, bytes, count);
+        m_BufferPos = (unsigned int)count;
+        return 0;
+    }
+
+    /* bypass the buffer */
+    done = 0;
+
+    while (done < count)
+    {
+        length = count - done;
+
+        if (length > BF_BULK_MAX)
+        {
+            length = BF_BULK_MAX;
+        }
+
+        result = write(m_Fd, bytes + done, length);
+
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+
+        if (m_Options & BF_OPT_CHECKSUM)
+        {
+            m_Crc = Crc32cUpdate(m_Crc, bytes + done, (size_t)result);
+        }
+
+        m_FilePos += (uint64_t)result;
+        done += (uint64_t)result;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : SkipZeros
+*   Description: This method adds zero bytes to the end of a byte aligned
+*                compact mode file without writing them.  The file is
+*                extended with ftruncate, which leaves a hole on file
+*                systems that support sparse files.
+*   Parameters : count - number of zero bytes
+*   Effects    : Flushes the buffer and extends the file.
+*   Returned   : true if the bytes were added, false if they still need to
+*                be written (not compact mode, not at the end of the file,
+*                or the file can't be extended).
+***************************************************************************/
+bool bit_file_c::SkipZeros(const uint64_t count)
+{
+    static const unsigned char zeros[BF_BULK_BLOCK] = {0};
+    struct stat status;
+    uint64_t end, done, length;
+
+    if ((m_Fd < 0) || (m_BitCount != 0))
+    {
+        return false;
+    }
+
+    if ((m_BufferPos != 0) && (FlushBuffer() == EOF))
+    {
+        return false;
+    }
+
+    if ((fstat(m_Fd, &status) != 0) ||
+        ((uint64_t)status.st_size != m_FilePos))
+    {
+        return false;
+    }
+
+    end = m_FilePos + count;
+
+    if ((ftruncate(m_Fd, (off_t)end) != 0) ||
+        (lseek(m_Fd, (off_t)end, SEEK_SET) < 0))
+    {
+        return false;
+    }
+
+    if (m_Options & BF_OPT_CHECKSUM)
+    {
+        for (done = 0; done < count; done += length)
+        {
+            length = count - done;
+
+            if (length > sizeof(zeros))
+            {
+                length = sizeof(zeros);
+            }
+
+            m_Crc = Crc32cUpdate(m_Crc, zeros, length);
+        }
+    }
+
+    m_FilePos = end;
+    return true;
+}
+
+/***************************************************************************
+*   Method     : WriteFragments
+*   Description: This method writes whole byte fragments to a compact mode
+*                file descriptor with writev.  The buffer is flushed first
+*                so the fragments land after it.
+*   Parameters : vec - array of fragments, each a multiple of 8 bits
+*                n - number of fragments in vec (BF_IOV_MAX or fewer)
+*                total - number of bytes in all of the fragments
+*   Effects    : Writes the fragments.  Sets the error state on failure.
+*   Returned   : EOF on failure, otherwise 0.
+***************************************************************************/
+int bit_file_c::WriteFragments(const bf_iovec_t *vec, const size_t n,
+    const uint64_t total)
+{
+    struct iovec iov[BF_IOV_MAX];
+    uint64_t done;
+    ssize_t result;
+    size_t i, first;
+
+    if ((m_BufferPos != 0) && (FlushBuffer() == EOF))
+    {
+        return EOF;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        iov[i].iov_base = (void *)vec[i].bits;
+        iov[i].iov_len = (size_t)(vec[i].count / 8);
+
+        if (m_Options & BF_OPT_CHECKSUM)
+        {
+            m_Crc = Crc32cUpdate(m_Crc, vec[i].bits, iov[i].iov_len);
+        }
+    }
+
+    done = 0;
+    first = 0;
+
+    while (done < total)
+    {
+        result = writev(m_Fd, iov + first, (int)(n - first));
+
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+
+        done += (uint64_t)result;
+        m_FilePos += (uint64_t)result;
+
+        /* skip what was written after a short write */
+        while ((first < n) && ((size_t)result >= iov[first].iov_len))
+        {
+            result -= (ssize_t)iov[first].iov_len;
+            first++;
+        }
+
+        if (first < n)
+        {
+            iov[first].iov_base = (char *)iov[first].iov_base + result;
+            iov[first].iov_len -= (size_t)result;
+        }
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : KernelCopy
+*   Description: This method copies bytes from this compact mode reader's
+*                file descriptor to a compact mode writer's file descriptor
+*                with copy_file_range, or sendfile if copy_file_range isn't
+*                supported for the pair.  Both buffers must be empty.
+*   Parameters : writer - bit file open for writing
+*                count - number of bytes to copy
+*   Effects    : Advances both files.  Sets the EOF state at end of file.
+*   Returned   : The number of bytes copied.  Fewer than count bytes are
+*                copied at EOF or if the kernel can't copy between the
+*                files.
+***************************************************************************/
+uint64_t bit_file_c::KernelCopy(bit_file_c &writer, const uint64_t count)
+{
+#if defined(__linux__)
+    uint64_t done, length;
+    ssize_t result;
+    bool useSendfile;
+
+    if (m_FdState != 0)
+    {
+        return 0;
+    }
+
+    /* buffer is consumed, the descriptor is at the next byte to read */
+    UpdateChecksum();
+    m_FilePos += m_BufferLen;
+    m_BufferPos = 0;
+    m_BufferLen = 0;
+    m_CrcPos = 0;
+
+    done = 0;
+    useSendfile = false;
+
+    while (done < count)
+    {
+        length = count - done;
+
+        if (length > BF_BULK_MAX)
+        {
+            length = BF_BULK_MAX;
+        }
+
+        if (useSendfile)
+        {
+            result = sendfile(writer.m_Fd, m_Fd, NULL, length);
+        }
+        else
+        {
+            result = copy_file_range(m_Fd, NULL, writer.m_Fd, NULL, length,
+                0);
+        }
+
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            if ((!useSendfile) && (0 == done))
+            {
+                /* e.g. EXDEV, EBADF (append), or no kernel support */
+                useSendfile = true;
+                continue;
+            }
+
+            /* let the caller copy the rest */
+            break;
+        }
+
+        if (0 == result)
+        {
+            m_FdState |= BF_FD_EOF;
+            break;
+        }
+
+        m_FilePos += (uint64_t)result;
+        writer.m_FilePos += (uint64_t)result;
+        done += (uint64_t)result;
+    }
+
+    return done;
+#else
+    (void)writer;
+    (void)count;
+    return 0;
+#endif
+}
+
+/***************************************************************************
+*   Method     : FillBuffer
+*   Description: This method refills an empty compact mode input buffer
+*                from the file descriptor, allocating the buffer if it was
+*                released, and returns the first byte read.
+*   Parameters : None
+*   Effects    : Reads up to m_BufferSize bytes from the file descriptor.
+*                Sets the EOF or error state as appropriate.
+*   Returned   : The first byte read (0 - 255) or EOF.
+***************************************************************************/
+int bit_file_c::FillBuffer(void)
+{
+    ssize_t result;
+    unsigned char byte;
+
+    if ((m_Fd < 0) || (m_FdState != 0))
+    {
+        return EOF;
+    }
+
+    if (0 == m_BufferSize)
+    {
+        /* unbuffered compact mode */
+        while ((result = read(m_Fd, &byte, 1)) < 0)
+        {
+            if (errno != EINTR)
+            {
+                m_FdState |= BF_FD_ERROR;
+                return EOF;
+            }
+        }
+
+        if (0 == result)
+        {
+            m_FdState |= BF_FD_EOF;
+            return EOF;
+        }
+
+        if (m_Options & BF_OPT_CHECKSUM)
+        {
+            m_Crc = Crc32cUpdate(m_Crc, &byte, 1);
+        }
+
+        m_FilePos++;
+        return byte;
+    }
+
+    if (NULL == m_Buffer)
+    {
+        /* allocate buffer on demand */
+        AllocBuffer();
+    }
+
+    /* everything in the buffer has been consumed */
+    UpdateChecksum();
+    m_FilePos += m_BufferLen;
+
+    while ((result = read(m_Fd, m_Buffer, m_BufferSize)) < 0)
+    {
+        if (errno != EINTR)
+        {
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+    }
+
+    m_BufferPos = 0;
+    m_BufferLen = (unsigned int)result;
+    m_CrcPos = 0;
+
+    if (0 == result)
+    {
+        m_FdState |= BF_FD_EOF;
+        return EOF;
+    }
+
+    return m_Buffer[m_BufferPos++];
+}
+
+/***************************************************************************
+*   Method     : FlushBuffer
+*   Description: This method writes the contents of a compact mode output
+*                buffer to the file descriptor.  The buffer itself is kept.
+*   Parameters : None
+*   Effects    : Writes buffered bytes and empties the buffer.  Sets the
+*                error state on failure.
+*   Returned   : EOF on failure, otherwise 0.
+***************************************************************************/
+int bit_file_c::FlushBuffer(void)
+{
+    unsigned int written;
+    ssize_t result;
+
+    if (m_Fd < 0)
+    {
+        return EOF;
+    }
+
+    UpdateChecksum();
+    written = 0;
+
+    while (written < m_BufferPos)
+    {
+        result = write(m_Fd, m_Buffer + written, m_BufferPos - written);
+
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+
+        written += (unsigned int)result;
+    }
+
+    m_FilePos += m_BufferPos;
+    m_BufferPos = 0;
+    m_CrcPos = 0;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : AllocBuffer
+*   Description: This method allocates the compact mode I/O buffer.
+*                Buffers of at least BF_HUGE_PAGE bytes are mapped from
+*                reserved huge pages if there are any, otherwise from
+*                ordinary pages marked for transparent huge pages, so a
+*                multi-megabyte buffer doesn't cost a TLB entry per 4 KB.
+*   Parameters : None
+*   Effects    : Allocates m_Buffer.
+*   Returned   : None
+*   Exception  : std::bad_alloc if the buffer can't be allocated.
+***************************************************************************/
+void bit_file_c::AllocBuffer(void)
+{
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (m_BufferSize >= BF_HUGE_PAGE)
+    {
+        size_t length = BF_HUGE_ROUND(m_BufferSize);
+        void *buffer = MAP_FAILED;
+
+#if defined(MAP_HUGETLB)
+        buffer = mmap(NULL, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+        if (MAP_FAILED == buffer)
+        {
+            buffer = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (MAP_FAILED == buffer)
+            {
+                throw std::bad_alloc();
+            }
+
+            madvise(buffer, length, MADV_HUGEPAGE);
+        }
+
+        m_Buffer = (unsigned char *)buffer;
+        return;
+    }
+#endif
+
+    m_Buffer = new unsigned char[m_BufferSize];
+}
+
+/***************************************************************************
+*   Method     : FreeBuffer
+*   Description: This method frees a buffer allocated by AllocBuffer.
+*   Parameters : None
+*   Effects    : Frees m_Buffer and sets it to NULL.
+*   Returned   : None
+***************************************************************************/
+void bit_file_c::FreeBuffer(void)
+{
+    if (NULL == m_Buffer)
+    {
+        return;
+    }
+
+#if defined(MAP_ANONYMOUS) && defined(MADV_HUGEPAGE)
+    if (m_BufferSize >= BF_HUGE_PAGE)
+    {
+        munmap(m_Buffer, BF_HUGE_ROUND(m_BufferSize));
+        m_Buffer = NULL;
+        return;
+    }
+#endif
+
+    delete[] m_Buffer;
+    m_Buffer = NULL;
+}
+
+/***************************************************************************
+*   Method     : SyncOutput
+*   Description: This method applies the durability of a compact mode
+*                output file.  Buffered bytes are written, then synced with
+*                fdatasync or registered with the group committer.
+*   Parameters : None
+*   Effects    : Flushes the buffer and syncs or registers the file.
+*   Returned   : EOF if a write or sync fails, otherwise 0.
+***************************************************************************/
+int bit_file_c::SyncOutput(void)
+{
+    if ((m_Fd < 0) || (BF_DURABLE_NONE == m_Durability))
+    {
+        return 0;
+    }
+
+    if (FlushBuffer() == EOF)
+    {
+        return EOF;
+    }
+
+    if (BF_DURABLE_GROUP == m_Durability)
+    {
+        return m_Committer->Register(m_Fd);
+    }
+
+    while (fdatasync(m_Fd) != 0)
+    {
+        if (errno != EINTR)
+        {
+            m_FdState |= BF_FD_ERROR;
+            return EOF;
+        }
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : UpdateChecksum
+*   Description: This method adds compact mode buffer bytes that have been
+*                consumed (reading) or filled (writing), but not yet added
+*                to the running checksum, to the checksum.  The bytes are
+*                added in bulk instead of one at a time.
+*   Parameters : None
+*   Effects    : Updates m_Crc and m_CrcPos.
+*   Returned   : None
+***************************************************************************/
+void bit_file_c::UpdateChecksum(void)
+{
+    if ((m_Options & BF_OPT_CHECKSUM) && (m_BufferPos > m_CrcPos))
+    {
+        m_Crc = Crc32cUpdate(m_Crc, m_Buffer + m_CrcPos,
+            m_BufferPos - m_CrcPos);
+    }
+
+    m_CrcPos = m_BufferPos;
+}
+
+/***************************************************************************
+*   Method     : SkipRun
+*   Description: This method reads bits equal to bitValue, up to max bits.
+*                Buffered bits are examined a byte at a time with clz.
+*                Once the bit buffer is empty, a compact mode buffer is
+*                scanned 16 bytes (SSE2) or 8 bytes at a time for the first
+*                byte that isn't all bitValue bits, so long runs are
+*                skipped without touching the bit buffer.
+*   Parameters : bitValue - the value (0 or 1) of the bits to skip
+*                max - most bits to skip
+*                stopped - set to true if a bit that differs was found
+*   Effects    : Reads past the run.  A differing bit is left in the bit
+*                buffer, or unread in the file if it starts a byte, so
+*                fewer than 8 bits are ever left in the bit buffer.
+*   Returned   : The number of bits skipped.
+***************************************************************************/
+uint64_t bit_file_c::SkipRun(const int bitValue, const uint64_t max,
+    bool *stopped)
+{
+    const unsigned char fill = (bitValue != 0) ? 0xFF : 0x00;
+    uint64_t run;
+    int c;
+
+    *stopped = false;
+    run = 0;
+
+    while (run < max)
+    {
+        if (m_BitCount != 0)
+        {
+            unsigned int diff, same;
+
+            /* 1 bits in diff differ from bitValue */
+            diff = ((unsigned char)m_BitBuffer ^ fill) &
+                ((1U << m_BitCount) - 1);
+            same = (0 == diff) ? m_BitCount :
+                m_BitCount - 32 + __builtin_clz(diff);
+
+            if (same >= max - run)
+            {
+                m_BitCount -= (unsigned char)(max - run);
+                return max;
+            }
+
+            m_BitCount -= same;
+            run += same;
+
+            if (diff != 0)
+            {
+                *stopped = true;
+                return run;
+            }
+
+            continue;
+        }
+
+        if (m_Buffer != NULL)
+        {
+            /* byte aligned, scan the buffer for a byte that differs */
+            const unsigned char *start = m_Buffer + m_BufferPos;
+            const unsigned char *in = start;
+            const unsigned char *stop = m_Buffer + m_BufferLen;
+            const uint64_t fillWord = (bitValue != 0) ? ~(uint64_t)0 : 0;
+
+            if ((max - run) / 8 < (uint64_t)(stop - in))
+            {
+                stop = in + ((max - run) / 8);
+            }
+
+#if defined(__SSE2__)
+            const __m128i fillBlock = _mm_set1_epi8((char)fill);
+
+            while (stop - in >= 16)
+            {
+                __m128i block = _mm_loadu_si128((const __m128i *)in);
+
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, fillBlock)) !=
+                    0xFFFF)
+                {
+                    break;
+                }
+
+                in += 16;
+            }
+#endif
+
+            while (stop - in >= 8)
+            {
+                uint64_t word;
+                int j;
+
+                word = 0;
+
+                for (j = 7; j >= 0; j--)
+                {
+                    word = (word << 8) | in[j];
+                }
+
+                word ^= fillWord;
+
+                if (word != 0)
+                {
+                    /* first differing byte is the lowest non-zero byte */
+                    in += __builtin_ctzll(word) / 8;
+                    break;
+                }
+
+                in += 8;
+            }
+
+            while ((in < stop) && (*in == fill))
+            {
+                in++;
+            }
+
+            run += 8 * (uint64_t)(in - start);
+            m_BufferPos = (unsigned int)(in - m_Buffer);
+
+            if (run >= max)
+            {
+                return run;
+            }
+        }
+
+        /* differing byte, partial byte, or buffer refill */
+        if ((c = PeekByte()) == EOF)
+        {
+            return run;
+        }
+
+        if (((unsigned char)c ^ fill) & 0x80)
+        {
+            /* the run ends at a byte boundary; leave the byte unread */
+            *stopped = true;
+            return run;
+        }
+
+        ReadByte();
+        m_BitBuffer = (char)c;
+        m_BitCount = 8;
+    }
+
+    return run;
+}
+
+/***************************************************************************
+*   Method     : PatchFile
+*   Description: This method changes bits in bytes of a compact mode output
+*                file that have already been written.  The bytes are read
+*                with pread, modified, and written back with pwrite.  The
+*                running checksum is corrected if it includes them.
+*   Parameters : first - file offset of the first byte to change
+*                masks - the bits to change in each byte
+*                bits - the new values of the changed bits
+*                count - number of bytes to change (9 or fewer)
+*   Effects    : Changes bytes in the file.
+*   Returned   : EOF for failure, otherwise 0.
+***************************************************************************/
+int bit_file_c::PatchFile(const uint64_t first, unsigned char *masks,
+    unsigned char *bits, const unsigned int count)
+{
+    unsigned char old[9], delta[9];
+    unsigned int i;
+    uint64_t start;
+    int flags;
+    ssize_t result;
+
+    if (pread(m_Fd, old, count, (off_t)first) != (ssize_t)count)
+    {
+        return EOF;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        delta[i] = old[i] ^ ((old[i] & ~masks[i]) | bits[i]);
+        old[i] ^= delta[i];
+    }
+
+    /* pwrite ignores the offset of O_APPEND descriptors */
+    flags = fcntl(m_Fd, F_GETFL);
+
+    if ((flags != -1) && (flags & O_APPEND))
+    {
+        fcntl(m_Fd, F_SETFL, flags & ~O_APPEND);
+    }
+
+    result = pwrite(m_Fd, old, count, (off_t)first);
+
+    if ((flags != -1) && (flags & O_APPEND))
+    {
+        fcntl(m_Fd, F_SETFL, flags);
+    }
+
+    if (result != (ssize_t)count)
+    {
+        m_FdState |= BF_FD_ERROR;
+        return EOF;
+    }
+
+    if ((m_Options & BF_OPT_CHECKSUM) && (first + count > m_CrcStart))
+    {
+        /* the checksum includes every byte written since m_CrcStart */
+        start = (first > m_CrcStart) ? first : m_CrcStart;
+
+        m_Crc = Crc32cAdjust(m_Crc, delta + (start - first),
+            (size_t)(first + count - start),
+            (m_FilePos + m_CrcPos) - (first + count));
+    }
+
+    return 0;
 }
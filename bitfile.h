@@ -66,6 +66,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <stdint.h>
+#include "bitcpu.h"
 
 /***************************************************************************
 *                            TYPE DEFINITIONS
@@ -78,6 +80,14 @@ typedef enum
     BF_NO_MODE
 } BF_MODES;
 
+/* how written data is made durable (compact mode only) */
+typedef enum
+{
+    BF_DURABLE_NONE,            /* left to the operating system */
+    BF_DURABLE_FLUSH,           /* fdatasync on FlushOutput and Close */
+    BF_DURABLE_GROUP            /* batched by a bit_committer_c */
+} BF_DURABILITY;
+
 typedef enum
 {
     BF_UNKNOWN_ENDIAN,
@@ -85,17 +95,58 @@ typedef enum
     BF_BIG_ENDIAN
 } endian_t;
 
+class bit_committer_c;
+
+/* writer checkpoint saved by SaveState and resumed by RestoreState */
+typedef struct
+{
+    uint64_t bytes;                 /* whole bytes in the file */
+    uint8_t bitCount;               /* bits written after them (0 - 7) */
+    uint8_t bitBuffer;              /* those bits, right justified */
+    uint8_t checksum;               /* non-zero if checksum is running */
+    uint32_t crc;                   /* CRC-32C of bytes from crcStart */
+    uint64_t crcStart;              /* file offset checksum started at */
+} bf_state_t;
+
+/* bits set aside by ReserveBits to be filled in later by PatchBits */
+typedef struct
+{
+    uint64_t offset;                /* bit offset of reservation in file */
+    unsigned int count;             /* number of bits reserved (<= 64) */
+} bf_reservation_t;
+
+/* one fragment of bits for PutBitsV */
+typedef struct
+{
+    const void *bits;               /* bits to write (msb first) */
+    uint64_t count;                 /* number of bits in fragment */
+} bf_iovec_t;
+
 class bit_file_c
 {
     public:
         bit_file_c(void);
         bit_file_c(const char *fileName, const BF_MODES mode);
+        bit_file_c(const char *fileName, const BF_MODES mode,
+            const unsigned int bufferSize);
         virtual ~bit_file_c(void);
 
         /* open/close bit file */
         void Open(const char *fileName, const BF_MODES mode);
         void Close(void);
 
+        /* open using a file descriptor and a small on demand buffer */
+        void Open(const char *fileName, const BF_MODES mode,
+            const unsigned int bufferSize);
+
+        /* free the on demand buffer of an idle compact mode file */
+        int ReleaseBuffer(void);
+
+        /* explicit compact mode buffer refill/drain (see bitfile_async.h) */
+        int Fill(void);
+        int Drain(void);
+        unsigned int Buffered(void) const;
+
         /* toss spare bits and byte align file */
         int ByteAlign(void);
 
@@ -111,8 +162,25 @@ class bit_file_c
         int PutBit(const int c);
 
         /* get/put number of bits */
-        int GetBits(void *bits, const unsigned int count);
-        int PutBits(void *bits, const unsigned int count);
+        int64_t GetBits(void *bits, const uint64_t count);
+        int64_t PutBits(void *bits, const uint64_t count);
+
+        /* get/put bits as one byte (0 or 1) per bit */
+        int64_t GetBitsAsBytes(uint8_t *out, const uint64_t count);
+        int64_t PutBitsFromBytes(const uint8_t *in, const uint64_t count);
+
+        /* put runs of 0 bits, 1 bits, or a repeating pattern */
+        int64_t PutZeros(const uint64_t count);
+        int64_t PutOnes(const uint64_t count);
+        int64_t PutPattern(const uint64_t pattern, const unsigned int period,
+            const uint64_t count);
+
+        /* put a list of fragments (gathered with writev when aligned) */
+        int64_t PutBitsV(const bf_iovec_t *vec, const size_t n);
+
+        /* copy bits from one bit file to another */
+        static int64_t CopyBits(bit_file_c &reader, bit_file_c &writer,
+            const uint64_t count);
 
         /* get/put number of bits to/from integer types (short, int, ...)*/
         /* size is size of data structure pointed to by bits.            */
@@ -121,6 +189,48 @@ class bit_file_c
         int PutBitsInt(void *bits, const unsigned int count,
             const size_t size);
 
+        /* get/put LEB128 varints, unsigned and zigzag signed */
+        int GetVarint(uint64_t *value);
+        int PutVarint(const uint64_t value);
+        int GetVarintSigned(int64_t *value);
+        int PutVarintSigned(const int64_t value);
+
+        /* get/put arrays of varints */
+        int64_t GetVarints(uint64_t *values, const size_t count);
+        int64_t PutVarints(const uint64_t *values, const size_t count);
+        int64_t GetVarintsSigned(int64_t *values, const size_t count);
+        int64_t PutVarintsSigned(const int64_t *values, const size_t count);
+
+        /* skip to the next 1 or 0 bit, or count a run of equal bits */
+        int64_t FindNextSet(void);
+        int64_t FindNextClear(void);
+        int64_t CountRun(const int bitValue, const uint64_t max);
+
+        /* bit position in file */
+        uint64_t Tell(void);
+
+        /* write placeholder bits now and fill them in later */
+        int ReserveBits(const unsigned int count,
+            bf_reservation_t *reservation);
+        int PatchBits(const bf_reservation_t *reservation,
+            const uint64_t value);
+
+        /* running CRC-32C of bytes read or written */
+        int SetChecksum(const bool enable);
+        uint32_t Checksum(void);
+
+        /* byte align and write/read and check a 4 byte checksum trailer */
+        int PutChecksum(void);
+        int VerifyChecksum(void);
+
+        /* checkpoint a writer and resume it after a crash */
+        int SaveState(bf_state_t *state);
+        int RestoreState(const bf_state_t *state);
+
+        /* make data durable on FlushOutput and Close */
+        int SetDurability(const BF_DURABILITY durability,
+            bit_committer_c *committer = NULL);
+
         /* status */
         bool eof(void);
         bool good(void);
@@ -134,6 +244,56 @@ class bit_file_c
         unsigned char m_BitCount;       /* number of bits in bitBuffer */
         BF_MODES m_Mode;                /* open for read, write, or append */
 
+        /* compact mode (file descriptor with on demand buffer) */
+        int m_Fd;                       /* file descriptor, -1 if unused */
+        unsigned char *m_Buffer;        /* I/O buffer, NULL while idle */
+        unsigned int m_BufferSize;      /* size of buffer, 0 unbuffered */
+        unsigned int m_BufferPos;       /* next byte to read/write */
+        unsigned int m_BufferLen;       /* valid bytes in read buffer */
+        uint64_t m_FilePos;             /* file offset of m_Buffer[0] */
+        unsigned char m_FdState;        /* BF_FD_EOF and BF_FD_ERROR bits */
+        unsigned char m_Options;        /* BF_OPT_ bits */
+
+        /* running checksum */
+        uint32_t m_Crc;                 /* CRC-32C of bytes folded so far */
+        unsigned int m_CrcPos;          /* first buffer byte not in m_Crc */
+        uint64_t m_CrcStart;            /* file offset of first m_Crc byte */
+
+        const bf_cpu_kernels_t *m_Kernels;  /* kernels for this processor */
+
+        /* durability */
+        BF_DURABILITY m_Durability;     /* when written data is synced */
+        bit_committer_c *m_Committer;   /* batches BF_DURABLE_GROUP syncs */
+
+        /* byte I/O shared by stream and compact modes */
+        int ReadByte(void);
+        int PeekByte(void);
+        int WriteByte(const int c);
+        uint64_t ReadBytes(unsigned char *bytes, const uint64_t count);
+        int WriteBytes(const unsigned char *bytes, const uint64_t count);
+        int FillBuffer(void);
+        int FlushBuffer(void);
+        void UpdateChecksum(void);
+        int SyncOutput(void);
+        void AllocBuffer(void);
+        void FreeBuffer(void);
+        uint64_t SkipRun(const int bitValue, const uint64_t max,
+            bool *stopped);
+        bool SkipZeros(const uint64_t count);
+        int WriteFragments(const bf_iovec_t *vec, const size_t n,
+            const uint64_t total);
+        uint64_t KernelCopy(bit_file_c &writer, const uint64_t count);
+        int PatchFile(const uint64_t first, unsigned char *masks,
+            unsigned char *bits, const unsigned int count);
+        bool IsReading(void) const;
+        bool IsWriting(void) const;
+
+        /* out of line parts of GetBit/PutBit */
+        int GetBitRefill(void);
+        int PutBitFlush(const int c);
+        void OpenFd(const char *fileName, const BF_MODES mode,
+            const unsigned int bufferSize);
+
         /* endianess aware methods used by GetBitsInt/PutBitsInt */
         int GetBitsLE(void *bits, const unsigned int count);
         int PutBitsLE(void *bits, const unsigned int count);
@@ -144,4 +304,44 @@ class bit_file_c
             const size_t size);
 };
 
+/***************************************************************************
+*                            INLINE METHODS
+* GetBit and PutBit are usually called in tight loops, so the common case
+* (a bit already in the bit buffer, or room for one more) is inline here.
+* Everything else is done out of line by GetBitRefill and PutBitFlush.
+***************************************************************************/
+inline bool bit_file_c::IsReading(void) const
+{
+    return ((m_InStream != NULL) || ((m_Fd >= 0) && (BF_READ == m_Mode)));
+}
+
+inline bool bit_file_c::IsWriting(void) const
+{
+    return ((m_OutStream != NULL) || ((m_Fd >= 0) && (BF_READ != m_Mode)));
+}
+
+inline int bit_file_c::GetBit(void)
+{
+    if ((m_BitCount != 0) && (BF_READ == m_Mode))
+    {
+        /* bit to return is msb in buffer */
+        m_BitCount--;
+        return ((m_BitBuffer >> m_BitCount) & 0x01);
+    }
+
+    return GetBitRefill();
+}
+
+inline int bit_file_c::PutBit(const int c)
+{
+    if ((m_BitCount < 7) && ((BF_WRITE == m_Mode) || (BF_APPEND == m_Mode)))
+    {
+        m_BitCount++;
+        m_BitBuffer = (char)((m_BitBuffer << 1) | (c != 0));
+        return c;
+    }
+
+    return PutBitFlush(c);
+}
+
 #endif  /* ndef __BITFILE_H */
@@ -0,0 +1,206 @@
+/***************************************************************************
+*                    Bit Stream File Coroutine Support Header
+*
+*   File    : bitfile_async.h
+*   Purpose : Provides C++20 awaitable wrappers for the blocking parts of
+*             compact mode bit_file_c objects.  co_await Fill() and
+*             co_await Drain() run bit_file_c::Fill/Drain on a pluggable
+*             executor and resume the awaiting coroutine when the I/O is
+*             done.  The bit level Get and Put methods are not wrapped;
+*             they stay synchronous and run from the in-memory buffer as
+*             long as the coroutine keeps it filled (reading) or drained
+*             (writing).  Header only; requires C++20.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITFILE_ASYNC_H
+#define __BITFILE_ASYNC_H
+
+#if !defined(__cpp_impl_coroutine) || (__cpp_impl_coroutine < 201902L)
+#error "bitfile_async.h requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "bitfile.h"
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* runs I/O jobs.  derive from this to plug in an event loop or pool. */
+class bf_executor_c
+{
+    public:
+        virtual ~bf_executor_c(void) {}
+
+        /* run job at some later point, on any thread */
+        virtual void Post(std::function<void(void)> job) = 0;
+};
+
+/* runs jobs immediately on the posting thread (blocking, for testing) */
+class bf_inline_executor_c : public bf_executor_c
+{
+    public:
+        void Post(std::function<void(void)> job) { job(); }
+};
+
+/* runs jobs in order on a single background I/O thread */
+class bf_thread_executor_c : public bf_executor_c
+{
+    public:
+        bf_thread_executor_c(void) :
+            m_Stop(false),
+            m_Thread(&bf_thread_executor_c::Run, this)
+        {
+        }
+
+        ~bf_thread_executor_c(void)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_Stop = true;
+            }
+
+            m_Wake.notify_one();
+            m_Thread.join();
+        }
+
+        void Post(std::function<void(void)> job)
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_Lock);
+                m_Jobs.push_back(std::move(job));
+            }
+
+            m_Wake.notify_one();
+        }
+
+    private:
+        std::mutex m_Lock;
+        std::condition_variable m_Wake;
+        std::deque<std::function<void(void)> > m_Jobs;
+        bool m_Stop;                    /* set by destructor */
+        std::thread m_Thread;           /* must be constructed last */
+
+        /* run queued jobs until stopped and the queue is empty */
+        void Run(void)
+        {
+            for (;;)
+            {
+                std::function<void(void)> job;
+
+                {
+                    std::unique_lock<std::mutex> lock(m_Lock);
+
+                    m_Wake.wait(lock,
+                        [this] { return m_Stop || !m_Jobs.empty(); });
+
+                    if (m_Jobs.empty())
+                    {
+                        return;
+                    }
+
+                    job = std::move(m_Jobs.front());
+                    m_Jobs.pop_front();
+                }
+
+                job();
+            }
+        }
+};
+
+/* awaitable that runs a bit_file_c buffer operation on an executor */
+class bf_io_awaitable_c
+{
+    public:
+        typedef int (bit_file_c::*operation_t)(void);
+
+        bf_io_awaitable_c(bit_file_c &file, bf_executor_c &executor,
+            operation_t operation) :
+            m_File(file),
+            m_Executor(executor),
+            m_Operation(operation),
+            m_Result(EOF)
+        {
+        }
+
+        bool await_ready(void) const noexcept { return false; }
+
+        /* the coroutine is resumed on the executor after the I/O */
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_Executor.Post([this, handle]
+                {
+                    m_Result = (m_File.*m_Operation)();
+                    handle.resume();
+                });
+        }
+
+        /* result of bit_file_c::Fill or bit_file_c::Drain */
+        int await_resume(void) const noexcept { return m_Result; }
+
+    private:
+        bit_file_c &m_File;
+        bf_executor_c &m_Executor;
+        operation_t m_Operation;
+        int m_Result;
+};
+
+/* compact mode bit file whose buffer refills/drains are awaitable */
+class bit_async_file_c
+{
+    public:
+        bit_async_file_c(bit_file_c &file, bf_executor_c &executor) :
+            m_File(file),
+            m_Executor(executor)
+        {
+        }
+
+        /* co_await Fill() - see bit_file_c::Fill */
+        bf_io_awaitable_c Fill(void)
+        {
+            return bf_io_awaitable_c(m_File, m_Executor, &bit_file_c::Fill);
+        }
+
+        /* co_await Drain() - see bit_file_c::Drain */
+        bf_io_awaitable_c Drain(void)
+        {
+            return bf_io_awaitable_c(m_File, m_Executor, &bit_file_c::Drain);
+        }
+
+        /* synchronous bit level access */
+        bit_file_c &File(void) { return m_File; }
+
+    private:
+        bit_file_c &m_File;
+        bf_executor_c &m_Executor;
+};
+
+#endif  /* ndef __BITFILE_ASYNC_H */
@@ -0,0 +1,481 @@
+/***************************************************************************
+*              Interleaved Multi-Stream Bit Writer/Reader Implementation
+*
+*   File    : bitmulti.cpp
+*   Purpose : This file implements classes that spread symbols round robin
+*             across N independent bit streams and read them back.  Each
+*             stream has its own 64 bit accumulator, so a reader that
+*             advances all of them in lockstep (GetBitsAll) has N
+*             independent chains of work for the processor to overlap.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include "bitmulti.h"
+#include "bitfile.h"
+
+using namespace std;
+
+/***************************************************************************
+*                        bit_multi_writer_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_multi_writer_c - constructor
+*   Description: This is the bit_multi_writer_c constructor.  An exception
+*                will be thrown on error.
+*   Parameters : streams - number of streams (1 to BF_MULTI_MAX_STREAMS)
+*   Effects    : Initializes private members.
+*   Returned   : None
+*   Exception  : "Error: Invalid Stream Count" - for bad streams value
+***************************************************************************/
+bit_multi_writer_c::bit_multi_writer_c(const unsigned int streams)
+{
+    if ((streams < 1) || (streams > BF_MULTI_MAX_STREAMS))
+    {
+        throw("Error: Invalid Stream Count");
+    }
+
+    m_Streams = streams;
+    Reset();
+}
+
+/***************************************************************************
+*   Method     : Reset
+*   Description: This method discards all symbols so the writer can be
+*                used for another block.  Stream memory is kept for reuse.
+*   Parameters : None
+*   Effects    : Empties every stream.
+*   Returned   : None
+***************************************************************************/
+void bit_multi_writer_c::Reset(void)
+{
+    unsigned int i;
+
+    m_Next = 0;
+
+    for (i = 0; i < BF_MULTI_MAX_STREAMS; i++)
+    {
+        m_Bytes[i].clear();
+        m_BitBuffer[i] = 0;
+        m_BitCount[i] = 0;
+    }
+}
+
+/***************************************************************************
+*   Method     : PutBits
+*   Description: This method adds a symbol to the next stream, round
+*                robin.  Symbol i goes to stream (i % N).
+*   Parameters : value - the symbol, right justified
+*                count - number of bits in the symbol (BF_MULTI_MAX_BITS or
+*                        fewer)
+*   Effects    : Appends the symbol's bits (msb first) to a stream.
+*   Returned   : EOF if count is too large, otherwise count.
+***************************************************************************/
+int bit_multi_writer_c::PutBits(const uint64_t value,
+    const unsigned int count)
+{
+    unsigned int s;
+
+    if (count > BF_MULTI_MAX_BITS)
+    {
+        return EOF;
+    }
+
+    s = m_Next;
+    m_Next = (m_Next + 1 == m_Streams) ? 0 : m_Next + 1;
+
+    if (0 == count)
+    {
+        return 0;
+    }
+
+    /* at most 7 bits are buffered, so 63 bits fit */
+    m_BitBuffer[s] = (m_BitBuffer[s] << count) |
+        (value & (((uint64_t)1 << count) - 1));
+    m_BitCount[s] += count;
+
+    while (m_BitCount[s] >= 8)
+    {
+        m_BitCount[s] -= 8;
+        m_Bytes[s].push_back((unsigned char)(m_BitBuffer[s] >>
+            m_BitCount[s]));
+    }
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : Write
+*   Description: This method pads each stream to a whole byte and writes
+*                the jump table (the size of each stream in bytes) followed
+*                by the streams.  The writer is then reset.
+*   Parameters : out - bit file open for writing
+*   Effects    : Writes to out and empties the writer.
+*   Returned   : EOF for failure, otherwise the number of bytes written.
+***************************************************************************/
+int64_t bit_multi_writer_c::Write(bit_file_c &out)
+{
+    unsigned int i;
+    size_t total;
+    int shift;
+
+    total = 4 * m_Streams;
+
+    for (i = 0; i < m_Streams; i++)
+    {
+        if (m_BitCount[i] != 0)
+        {
+            m_Bytes[i].push_back((unsigned char)(m_BitBuffer[i] <<
+                (8 - m_BitCount[i])));
+            m_BitCount[i] = 0;
+        }
+
+        if (m_Bytes[i].size() > 0xFFFFFFFFUL)
+        {
+            return EOF;
+        }
+
+        /* jump table entry */
+        for (shift = 24; shift >= 0; shift -= 8)
+        {
+            if (out.PutChar((int)((m_Bytes[i].size() >> shift) & 0xFF)) ==
+                EOF)
+            {
+                return EOF;
+            }
+        }
+
+        total += m_Bytes[i].size();
+    }
+
+    for (i = 0; i < m_Streams; i++)
+    {
+        if ((m_Bytes[i].size() > 0) &&
+            (out.PutBits(&m_Bytes[i][0], m_Bytes[i].size() * 8) == EOF))
+        {
+            return EOF;
+        }
+    }
+
+    Reset();
+    return (int64_t)total;
+}
+
+/***************************************************************************
+*   Method     : Streams
+*   Description: This method returns the number of streams.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of streams.
+***************************************************************************/
+unsigned int bit_multi_writer_c::Streams(void) const
+{
+    return m_Streams;
+}
+
+/***************************************************************************
+*                        bit_multi_reader_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_multi_reader_c - constructor
+*   Description: This is the bit_multi_reader_c constructor.  An exception
+*                will be thrown on error.
+*   Parameters : streams - number of streams (1 to BF_MULTI_MAX_STREAMS)
+*   Effects    : Initializes private members.
+*   Returned   : None
+*   Exception  : "Error: Invalid Stream Count" - for bad streams value
+***************************************************************************/
+bit_multi_reader_c::bit_multi_reader_c(const unsigned int streams)
+{
+    unsigned int i;
+
+    if ((streams < 1) || (streams > BF_MULTI_MAX_STREAMS))
+    {
+        throw("Error: Invalid Stream Count");
+    }
+
+    m_Streams = streams;
+    m_Next = 0;
+
+    for (i = 0; i < BF_MULTI_MAX_STREAMS; i++)
+    {
+        m_Data[i] = NULL;
+        m_Size[i] = 0;
+        m_Pos[i] = 0;
+        m_BitBuffer[i] = 0;
+        m_BitCount[i] = 0;
+    }
+}
+
+/***************************************************************************
+*   Method     : Open
+*   Description: This method parses a jump table and sets up a reader for
+*                each stream.  The streams are read in place, so data must
+*                outlive the reader.
+*   Parameters : data - jump table followed by the streams
+*                size - number of bytes in data
+*   Effects    : Initializes the stream readers.
+*   Returned   : EOF if the jump table doesn't fit the data, otherwise the
+*                number of bytes used.
+***************************************************************************/
+int64_t bit_multi_reader_c::Open(const void *data, const uint64_t size)
+{
+    const unsigned char *bytes;
+    uint64_t offset;
+    unsigned int i;
+
+    bytes = (const unsigned char *)data;
+    offset = 4 * m_Streams;
+
+    if ((bytes == NULL) || (size < offset))
+    {
+        return EOF;
+    }
+
+    for (i = 0; i < m_Streams; i++)
+    {
+        m_Size[i] = ((uint64_t)bytes[4 * i] << 24) |
+            ((uint64_t)bytes[(4 * i) + 1] << 16) |
+            ((uint64_t)bytes[(4 * i) + 2] << 8) |
+            (uint64_t)bytes[(4 * i) + 3];
+        m_Data[i] = bytes + offset;
+        m_Pos[i] = 0;
+        m_BitBuffer[i] = 0;
+        m_BitCount[i] = 0;
+
+        offset += m_Size[i];
+
+        if (offset > size)
+        {
+            return EOF;
+        }
+    }
+
+    m_Next = 0;
+    return (int64_t)offset;
+}
+
+/***************************************************************************
+*   Method     : Read
+*   Description: This method reads a jump table and the streams it
+*                describes from a bit file into memory and sets up a reader
+*                for each stream.
+*   Parameters : in - bit file open for reading
+*   Effects    : Reads from in.
+*   Returned   : EOF for failure, otherwise the number of bytes read.
+***************************************************************************/
+int64_t bit_multi_reader_c::Read(bit_file_c &in)
+{
+    uint64_t total;
+    unsigned int i;
+    int c, j;
+
+    m_Storage.resize(4 * m_Streams);
+    total = 0;
+
+    for (i = 0; i < 4 * m_Streams; i++)
+    {
+        if ((c = in.GetChar()) == EOF)
+        {
+            return EOF;
+        }
+
+        m_Storage[i] = (unsigned char)c;
+    }
+
+    for (i = 0; i < m_Streams; i++)
+    {
+        uint64_t length = 0;
+
+        for (j = 0; j < 4; j++)
+        {
+            length = (length << 8) | m_Storage[(4 * i) + j];
+        }
+
+        total += length;
+    }
+
+    m_Storage.resize((4 * m_Streams) + total);
+
+    if ((total > 0) &&
+        (in.GetBits(&m_Storage[4 * m_Streams], total * 8) == EOF))
+    {
+        return EOF;
+    }
+
+    return Open(&m_Storage[0], m_Storage.size());
+}
+
+/***************************************************************************
+*   Method     : Fill
+*   Description: This method loads whole bytes into a stream's bit buffer
+*                until it holds at least 56 bits or the stream is
+*                exhausted.
+*   Parameters : stream - the stream to refill
+*   Effects    : Updates the stream's bit buffer and position.
+*   Returned   : None
+***************************************************************************/
+void bit_multi_reader_c::Fill(const unsigned int stream)
+{
+    const unsigned char *bytes = m_Data[stream] + m_Pos[stream];
+    unsigned int count;
+
+    if (m_Pos[stream] + 8 <= m_Size[stream])
+    {
+        uint64_t word = 0;
+        int i;
+
+        for (i = 0; i < 8; i++)
+        {
+            word = (word << 8) | bytes[i];
+        }
+
+        /* count is at most 7 so the shift is always less than 64 */
+        count = (63 - m_BitCount[stream]) / 8;
+
+        if (count != 0)
+        {
+            m_BitBuffer[stream] = (m_BitBuffer[stream] << (8 * count)) |
+                (word >> (64 - (8 * count)));
+            m_BitCount[stream] += 8 * count;
+            m_Pos[stream] += count;
+        }
+
+        return;
+    }
+
+    while ((m_BitCount[stream] <= 56) && (m_Pos[stream] < m_Size[stream]))
+    {
+        m_BitBuffer[stream] = (m_BitBuffer[stream] << 8) |
+            m_Data[stream][m_Pos[stream]];
+        m_BitCount[stream] += 8;
+        m_Pos[stream]++;
+    }
+}
+
+/***************************************************************************
+*   Method     : GetBits
+*   Description: This method reads the next symbol, round robin, so
+*                symbols come back in the order they were given to
+*                bit_multi_writer_c::PutBits.
+*   Parameters : value - address to store the symbol (right justified)
+*                count - number of bits in the symbol (BF_MULTI_MAX_BITS or
+*                        fewer)
+*   Effects    : Advances one stream.
+*   Returned   : EOF for failure, otherwise count.
+***************************************************************************/
+int bit_multi_reader_c::GetBits(uint64_t *value, const unsigned int count)
+{
+    unsigned int s;
+
+    if ((value == NULL) || (count > BF_MULTI_MAX_BITS))
+    {
+        return EOF;
+    }
+
+    s = m_Next;
+
+    if (m_BitCount[s] < count)
+    {
+        Fill(s);
+
+        if (m_BitCount[s] < count)
+        {
+            return EOF;
+        }
+    }
+
+    m_Next = (m_Next + 1 == m_Streams) ? 0 : m_Next + 1;
+    m_BitCount[s] -= count;
+    *value = (m_BitBuffer[s] >> m_BitCount[s]) &
+        (((uint64_t)1 << count) - 1);
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : GetBitsAll
+*   Description: This method reads one count bit symbol from every stream,
+*                advancing them in lockstep.  Calling it is the same as
+*                calling GetBits N times when the next symbol is in stream
+*                0, but the streams' accumulators don't depend on each
+*                other, so their work can overlap.
+*   Parameters : values - array of N values to receive the symbols
+*                count - number of bits in each symbol (BF_MULTI_MAX_BITS
+*                        or fewer)
+*   Effects    : Advances every stream.
+*   Returned   : EOF if any stream runs out or the round robin isn't at
+*                stream 0, otherwise the number of symbols read (N).
+***************************************************************************/
+int bit_multi_reader_c::GetBitsAll(uint64_t *values,
+    const unsigned int count)
+{
+    const uint64_t mask = ((uint64_t)1 << count) - 1;
+    unsigned int s;
+
+    if ((values == NULL) || (count > BF_MULTI_MAX_BITS) || (m_Next != 0))
+    {
+        return EOF;
+    }
+
+    /* make sure every stream has the bits before consuming any */
+    for (s = 0; s < m_Streams; s++)
+    {
+        if (m_BitCount[s] < count)
+        {
+            Fill(s);
+
+            if (m_BitCount[s] < count)
+            {
+                return EOF;
+            }
+        }
+    }
+
+    for (s = 0; s < m_Streams; s++)
+    {
+        m_BitCount[s] -= count;
+        values[s] = (m_BitBuffer[s] >> m_BitCount[s]) & mask;
+    }
+
+    return (int)m_Streams;
+}
+
+/***************************************************************************
+*   Method     : Streams
+*   Description: This method returns the number of streams.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of streams.
+***************************************************************************/
+unsigned int bit_multi_reader_c::Streams(void) const
+{
+    return m_Streams;
+}
@@ -0,0 +1,116 @@
+/***************************************************************************
+*                  Interleaved Multi-Stream Bit Writer/Reader Header
+*
+*   File    : bitmulti.h
+*   Purpose : Provides definitions and prototypes for classes that spread
+*             symbols round robin across N independent bit streams and read
+*             them back.  Decoding N streams in lockstep gives the
+*             processor N independent dependency chains to overlap, instead
+*             of one chain through a single bit buffer (the layout used by
+*             4-stream Huffman decoders).
+*
+*             Layout written by bit_multi_writer_c::Write:
+*                 N stream sizes in bytes, 32 bits each, msb first
+*                 stream 0, stream 1, ... stream N-1, each zero padded to a
+*                 whole byte
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITMULTI_H
+#define __BITMULTI_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class bit_file_c;
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+#define BF_MULTI_MAX_STREAMS    16      /* most interleaved streams */
+#define BF_MULTI_MAX_BITS       56      /* most bits per symbol */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* collects symbols round robin into N in-memory bit streams */
+class bit_multi_writer_c
+{
+    public:
+        bit_multi_writer_c(const unsigned int streams);
+
+        /* add a symbol (right justified, msb first) to the next stream */
+        int PutBits(const uint64_t value, const unsigned int count);
+
+        /* write jump table and streams, then start over */
+        int64_t Write(bit_file_c &out);
+        void Reset(void);
+
+        unsigned int Streams(void) const;
+
+    private:
+        unsigned int m_Streams;         /* number of streams */
+        unsigned int m_Next;            /* stream for next symbol */
+        std::vector<unsigned char> m_Bytes[BF_MULTI_MAX_STREAMS];
+        uint64_t m_BitBuffer[BF_MULTI_MAX_STREAMS];
+        unsigned char m_BitCount[BF_MULTI_MAX_STREAMS];
+};
+
+/* reads symbols round robin from N streams written by bit_multi_writer_c */
+class bit_multi_reader_c
+{
+    public:
+        bit_multi_reader_c(const unsigned int streams);
+
+        /* use jump table and streams in memory (not copied) */
+        int64_t Open(const void *data, const uint64_t size);
+
+        /* read jump table and streams from a bit file into memory */
+        int64_t Read(bit_file_c &in);
+
+        /* get the next symbol (round robin) */
+        int GetBits(uint64_t *value, const unsigned int count);
+
+        /* get one count bit symbol from every stream, in stream order */
+        int GetBitsAll(uint64_t *values, const unsigned int count);
+
+        unsigned int Streams(void) const;
+
+    private:
+        unsigned int m_Streams;         /* number of streams */
+        unsigned int m_Next;            /* stream for next symbol */
+        std::vector<unsigned char> m_Storage;   /* streams read by Read */
+        const unsigned char *m_Data[BF_MULTI_MAX_STREAMS];
+        uint64_t m_Size[BF_MULTI_MAX_STREAMS];
+        uint64_t m_Pos[BF_MULTI_MAX_STREAMS];
+        uint64_t m_BitBuffer[BF_MULTI_MAX_STREAMS];
+        unsigned char m_BitCount[BF_MULTI_MAX_STREAMS];
+
+        void Fill(const unsigned int stream);
+};
+
+#endif  /* ndef __BITMULTI_H */
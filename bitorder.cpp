@@ -0,0 +1,348 @@
+/***************************************************************************
+*                  Bit Order Transcoding Implementation
+*
+*   File    : bitorder.cpp
+*   Purpose : This file implements bulk bit reversal for converting data
+*             between msb first and lsb first bit order.  No lookup
+*             tables are used: the portable version swaps bit fields 8
+*             bytes at a time, the SSSE3 version looks up nibbles with
+*             pshufb, and the GFNI version reverses 16 bytes with a single
+*             affine transform.  Word byte swaps are folded into the same
+*             pshufb.  The fastest version the processor supports is
+*             chosen the first time it is needed.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "bitorder.h"
+#include "bitfile.h"
+#include "bitcpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BITORDER_X86
+#endif
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define BITORDER_BLOCK  16384           /* bytes transcoded at a time */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef void (*reverse_fn_t)(unsigned char *dst, const unsigned char *src,
+    size_t len, size_t size);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : ReverseSoftware
+*   Description: This function reverses the bits of each size byte word
+*                without special instructions.  The bits of 8 bytes are
+*                reversed at once by swapping adjacent bits, bit pairs, and
+*                nibbles, then the bytes of each word are swapped the same
+*                way.
+*   Parameters : dst - where to write the reversed words
+*                src - words to reverse (may equal dst)
+*                len - number of bytes (a multiple of size)
+*                size - bytes per word (1, 2, 4, or 8)
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+static void ReverseSoftware(unsigned char *dst, const unsigned char *src,
+    size_t len, size_t size)
+{
+    unsigned char word[8];
+    uint64_t x;
+    size_t i, j;
+
+    for (i = 0; i + 8 <= len; i += 8)
+    {
+        memcpy(&x, src + i, sizeof(x));
+        x = ((x >> 1) & 0x5555555555555555ULL) |
+            ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) |
+            ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) |
+            ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+
+        /* swap bytes, then byte pairs, then halves for larger words */
+        if (size >= 2)
+        {
+            x = ((x >> 8) & 0x00FF00FF00FF00FFULL) |
+                ((x & 0x00FF00FF00FF00FFULL) << 8);
+        }
+
+        if (size >= 4)
+        {
+            x = ((x >> 16) & 0x0000FFFF0000FFFFULL) |
+                ((x & 0x0000FFFF0000FFFFULL) << 16);
+        }
+
+        if (size >= 8)
+        {
+            x = (x >> 32) | (x << 32);
+        }
+
+        memcpy(dst + i, &x, sizeof(x));
+    }
+
+    /* fewer than 8 bytes left, so size is 1, 2, or 4 */
+    for (; i < len; i += size)
+    {
+        for (j = 0; j < size; j++)
+        {
+            unsigned char b = src[i + j];
+
+            b = (unsigned char)(((b >> 1) & 0x55) | ((b & 0x55) << 1));
+            b = (unsigned char)(((b >> 2) & 0x33) | ((b & 0x33) << 2));
+            word[size - 1 - j] = (unsigned char)((b >> 4) | (b << 4));
+        }
+
+        memcpy(dst + i, word, size);
+    }
+}
+
+#ifdef BITORDER_X86
+/***************************************************************************
+*   Function   : ByteOrderMask
+*   Description: This function returns the pshufb control that reverses
+*                the bytes of each size byte word in a 16 byte vector.
+*   Parameters : size - bytes per word (1, 2, 4, or 8)
+*   Effects    : None
+*   Returned   : The shuffle control.
+***************************************************************************/
+__attribute__((target("ssse3")))
+static __m128i ByteOrderMask(size_t size)
+{
+    unsigned char mask[16];
+    size_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        mask[i] = (unsigned char)(((i / size) * size) +
+            (size - 1 - (i % size)));
+    }
+
+    return _mm_loadu_si128((const __m128i *)mask);
+}
+
+/***************************************************************************
+*   Function   : ReverseSsse3
+*   Description: This function reverses the bits of each size byte word
+*                16 bytes at a time.  pshufb looks up the reversed low and
+*                high nibbles of every byte in a 16 entry in-register
+*                table, and another pshufb swaps the bytes of each word.
+*   Parameters : dst - where to write the reversed words
+*                src - words to reverse (may equal dst)
+*                len - number of bytes (a multiple of size)
+*                size - bytes per word (1, 2, 4, or 8)
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("ssse3")))
+static void ReverseSsse3(unsigned char *dst, const unsigned char *src,
+    size_t len, size_t size)
+{
+    const __m128i lowTable = _mm_setr_epi8(0x00, (char)0x80, 0x40,
+        (char)0xC0, 0x20, (char)0xA0, 0x60, (char)0xE0, 0x10, (char)0x90,
+        0x50, (char)0xD0, 0x30, (char)0xB0, 0x70, (char)0xF0);
+    const __m128i highTable = _mm_setr_epi8(0x00, 0x08, 0x04, 0x0C, 0x02,
+        0x0A, 0x06, 0x0E, 0x01, 0x09, 0x05, 0x0D, 0x03, 0x0B, 0x07, 0x0F);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i order = ByteOrderMask(size);
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i low = _mm_and_si128(v, nibble);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+
+        v = _mm_or_si128(_mm_shuffle_epi8(lowTable, low),
+            _mm_shuffle_epi8(highTable, high));
+        v = _mm_shuffle_epi8(v, order);
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+
+    ReverseSoftware(dst + i, src + i, len - i, size);
+}
+
+/***************************************************************************
+*   Function   : ReverseGfni
+*   Description: This function reverses the bits of each size byte word
+*                16 bytes at a time.  A GF(2) affine transform with the
+*                anti-diagonal bit matrix reverses the bits of every byte
+*                in one instruction, and pshufb swaps the bytes of each
+*                word.
+*   Parameters : dst - where to write the reversed words
+*                src - words to reverse (may equal dst)
+*                len - number of bytes (a multiple of size)
+*                size - bytes per word (1, 2, 4, or 8)
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("gfni,ssse3")))
+static void ReverseGfni(unsigned char *dst, const unsigned char *src,
+    size_t len, size_t size)
+{
+    const __m128i matrix = _mm_set1_epi64x(0x8040201008040201LL);
+    const __m128i order = ByteOrderMask(size);
+    size_t i;
+
+    for (i = 0; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+
+        v = _mm_gf2p8affine_epi64_epi8(v, matrix, 0);
+        v = _mm_shuffle_epi8(v, order);
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+
+    ReverseSoftware(dst + i, src + i, len - i, size);
+}
+#endif
+
+/***************************************************************************
+*   Function   : ReverseSelect
+*   Description: This function selects the fastest bit reversal supported
+*                by the processor.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Pointer to the reversal function.
+***************************************************************************/
+static reverse_fn_t ReverseSelect(void)
+{
+#ifdef BITORDER_X86
+    unsigned int features = BitCpuFeatures();
+
+    if ((features & BF_CPU_GFNI) && (features & BF_CPU_SSSE3))
+    {
+        return ReverseGfni;
+    }
+
+    if (features & BF_CPU_SSSE3)
+    {
+        return ReverseSsse3;
+    }
+#endif
+
+    return ReverseSoftware;
+}
+
+/***************************************************************************
+*   Function   : BitReverseWords
+*   Description: This function reverses the bits of each size byte word,
+*                so the first bit of a word becomes its last.  For size 1
+*                this converts between msb first and lsb first bytes;
+*                larger sizes also swap the byte order of each word.
+*   Parameters : dst - where to write the reversed words
+*                src - words to reverse (may equal dst)
+*                len - number of bytes (a multiple of size)
+*                size - bytes per word (1, 2, 4, or 8)
+*   Effects    : Writes len bytes to dst.
+*   Returned   : EOF for a bad size or len, otherwise 0.
+***************************************************************************/
+int BitReverseWords(void *dst, const void *src, size_t len, size_t size)
+{
+    static const reverse_fn_t reverse = ReverseSelect();
+
+    if (((size != 1) && (size != 2) && (size != 4) && (size != 8)) ||
+        ((len % size) != 0) || (((dst == NULL) || (src == NULL)) &&
+        (len != 0)))
+    {
+        return EOF;
+    }
+
+    reverse((unsigned char *)dst, (const unsigned char *)src, len, size);
+    return 0;
+}
+
+/***************************************************************************
+*   Function   : BitReverseBytes
+*   Description: This function reverses the bits of each byte, converting
+*                between msb first and lsb first bit order.
+*   Parameters : dst - where to write the reversed bytes
+*                src - bytes to reverse (may equal dst)
+*                len - number of bytes
+*   Effects    : Writes len bytes to dst.
+*   Returned   : None
+***************************************************************************/
+void BitReverseBytes(void *dst, const void *src, size_t len)
+{
+    BitReverseWords(dst, src, len, 1);
+}
+
+/***************************************************************************
+*   Function   : BitTranscode
+*   Description: This function copies bytes from one bit file to another,
+*                reversing the bits of each size byte word on the way.  The
+*                data moves through a block with the bulk GetBits and
+*                PutBits paths, so neither file needs to be byte aligned.
+*   Parameters : reader - bit file open for reading
+*                writer - bit file open for writing
+*                bytes - number of bytes to copy (a multiple of size)
+*                size - bytes per word (1, 2, 4, or 8)
+*   Effects    : Reads from reader and writes to writer.
+*   Returned   : EOF for failure, otherwise the number of bytes copied.
+***************************************************************************/
+int64_t BitTranscode(bit_file_c &reader, bit_file_c &writer,
+    uint64_t bytes, size_t size)
+{
+    unsigned char block[BITORDER_BLOCK];
+    uint64_t done, length;
+
+    if (((size != 1) && (size != 2) && (size != 4) && (size != 8)) ||
+        ((bytes % size) != 0))
+    {
+        return EOF;
+    }
+
+    for (done = 0; done < bytes; done += length)
+    {
+        length = bytes - done;
+
+        if (length > sizeof(block))
+        {
+            length = sizeof(block);
+        }
+
+        if ((reader.GetBits(block, length * 8) == EOF) ||
+            (BitReverseWords(block, block, (size_t)length, size) == EOF) ||
+            (writer.PutBits(block, length * 8) == EOF))
+        {
+            return EOF;
+        }
+    }
+
+    return (int64_t)bytes;
+}
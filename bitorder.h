@@ -0,0 +1,59 @@
+/***************************************************************************
+*                     Bit Order Transcoding Header
+*
+*   File    : bitorder.h
+*   Purpose : Provides prototypes for converting data between msb first
+*             (bit_file_c) and lsb first bit order, and optionally between
+*             big and little endian fields.  Reversing the bits of each
+*             byte turns an msb first stream into the lsb first stream
+*             holding the same bits in the same order.  Reversing the bits
+*             of each 2, 4, or 8 byte word also swaps the byte order of
+*             those words.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITORDER_H
+#define __BITORDER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class bit_file_c;
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* reverse the bits of each byte.  dst may equal src. */
+void BitReverseBytes(void *dst, const void *src, size_t len);
+
+/* reverse the bits of each size (1, 2, 4, or 8) byte word */
+int BitReverseWords(void *dst, const void *src, size_t len, size_t size);
+
+/* copy bytes from reader to writer reversing each size byte word */
+int64_t BitTranscode(bit_file_c &reader, bit_file_c &writer,
+    uint64_t bytes, size_t size);
+
+#endif  /* ndef __BITORDER_H */
@@ -0,0 +1,378 @@
+/***************************************************************************
+*                  Push Mode (Resumable) Bit Reader Implementation
+*
+*   File    : bitpush.cpp
+*   Purpose : This file implements a bit reader that is fed its input a
+*             chunk at a time.  Input is kept in a growing buffer with
+*             already read bytes trimmed from its front.  Each read runs a
+*             bit_cursor_c over the unread data and only moves the read
+*             position if the cursor succeeded, so a read that runs out of
+*             data leaves nothing half consumed.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include "bitpush.h"
+#include "bitcursor.h"
+
+using namespace std;
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* longest LEB128 encoding of a 64 bit value */
+#define BF_VARINT_MAX   10
+
+/***************************************************************************
+*                                METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_push_reader_c - constructor
+*   Description: This is the bit_push_reader_c constructor.  It creates a
+*                reader that hasn't been fed any data.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_push_reader_c::bit_push_reader_c(void)
+{
+    m_BitPos = 0;
+    m_Consumed = 0;
+    m_Finished = false;
+}
+
+/***************************************************************************
+*   Method     : Feed
+*   Description: This method adds a chunk of input after the data already
+*                fed.  Bytes that have been completely read are dropped
+*                first once they make up most of the buffer.
+*   Parameters : data - the input bytes
+*                size - number of bytes in data
+*   Effects    : Copies data into the reader.
+*   Returned   : EOF if data is NULL or Finish() was called, otherwise 0.
+***************************************************************************/
+int bit_push_reader_c::Feed(const void *data, const size_t size)
+{
+    const unsigned char *bytes;
+    uint64_t drop;
+
+    if (m_Finished || ((data == NULL) && (size != 0)))
+    {
+        return EOF;
+    }
+
+    drop = m_BitPos / 8;
+
+    if ((drop != 0) && (drop >= m_Data.size() / 2))
+    {
+        m_Data.erase(m_Data.begin(), m_Data.begin() + drop);
+        m_BitPos -= drop * 8;
+        m_Consumed += drop;
+    }
+
+    bytes = (const unsigned char *)data;
+    m_Data.insert(m_Data.end(), bytes, bytes + size);
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Finish
+*   Description: This method tells the reader that no more input is coming,
+*                so reads that run past the end return EOF.
+*   Parameters : None
+*   Effects    : Marks the input as complete.
+*   Returned   : None
+***************************************************************************/
+void bit_push_reader_c::Finish(void)
+{
+    m_Finished = true;
+}
+
+/***************************************************************************
+*   Method     : Short
+*   Description: This method returns the value for a read that ran past
+*                the data fed so far.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : EOF after Finish(), otherwise BF_NEED_MORE_DATA.
+***************************************************************************/
+int bit_push_reader_c::Short(void) const
+{
+    return m_Finished ? EOF : BF_NEED_MORE_DATA;
+}
+
+/***************************************************************************
+*   Method     : ByteAlign
+*   Description: This method aligns the reader to the next byte boundary by
+*                discarding the rest of a partially read byte.  The bits
+*                have already been fed, so this never needs more data.
+*   Parameters : None
+*   Effects    : Moves the read position.
+*   Returned   : The number of bits discarded.
+***************************************************************************/
+int bit_push_reader_c::ByteAlign(void)
+{
+    int discard;
+
+    discard = (8 - (m_BitPos % 8)) % 8;
+    m_BitPos += discard;
+    return discard;
+}
+
+/***************************************************************************
+*   Method     : GetChar
+*   Description: This method returns the next 8 bits as a byte.
+*   Parameters : None
+*   Effects    : Moves the read position 8 bits if they were available.
+*   Returned   : The character read, BF_NEED_MORE_DATA, or EOF.
+***************************************************************************/
+int bit_push_reader_c::GetChar(void)
+{
+    bit_cursor_c cursor(m_Data.empty() ? NULL : &m_Data[0], m_Data.size(),
+        m_BitPos);
+    int returnValue;
+
+    if ((returnValue = cursor.GetChar()) == EOF)
+    {
+        return Short();
+    }
+
+    m_BitPos += 8;
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : GetBit
+*   Description: This method returns the next bit.
+*   Parameters : None
+*   Effects    : Moves the read position 1 bit if it was available.
+*   Returned   : 0 if bit == 0, 1 if bit == 1, BF_NEED_MORE_DATA, or EOF.
+***************************************************************************/
+int bit_push_reader_c::GetBit(void)
+{
+    uint64_t byte;
+
+    if (Available() == 0)
+    {
+        return Short();
+    }
+
+    byte = m_BitPos / 8;
+    m_BitPos++;
+    return (m_Data[byte] >> (7 - ((m_BitPos - 1) % 8))) & 0x01;
+}
+
+/***************************************************************************
+*   Method     : GetBits
+*   Description: This method reads the specified number of bits and writes
+*                them to the requested memory location (msb to lsb).
+*                Nothing is read unless all count bits are available.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*   Effects    : Moves the read position count bits if they were
+*                available.
+*   Returned   : The number of bits read, BF_NEED_MORE_DATA, or EOF.
+***************************************************************************/
+int64_t bit_push_reader_c::GetBits(void *bits, const uint64_t count)
+{
+    if (bits == NULL)
+    {
+        return EOF;
+    }
+
+    if (Available() < count)
+    {
+        return Short();
+    }
+
+    bit_cursor_c cursor(m_Data.empty() ? NULL : &m_Data[0], m_Data.size(),
+        m_BitPos);
+
+    if (cursor.GetBits(bits, count) == EOF)
+    {
+        return EOF;
+    }
+
+    m_BitPos += count;
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method:    : GetBitsInt
+*   Description: This method reads bits into an integer type variable
+*                (short, int, long, ...) the same way as
+*                bit_file_c::GetBitsInt.  Nothing is read unless all count
+*                bits are available.
+*   Parameters : bits - address to store bits read
+*                count - number of bits to read
+*                size - sizeof type containing "bits"
+*   Effects    : Moves the read position count bits if they were
+*                available.
+*   Returned   : The number of bits read, BF_NEED_MORE_DATA, or EOF.
+***************************************************************************/
+int bit_push_reader_c::GetBitsInt(void *bits, const unsigned int count,
+    const size_t size)
+{
+    int returnValue;
+
+    if (bits == NULL)
+    {
+        return EOF;
+    }
+
+    if (Available() < count)
+    {
+        return Short();
+    }
+
+    bit_cursor_c cursor(m_Data.empty() ? NULL : &m_Data[0], m_Data.size(),
+        m_BitPos);
+
+    if ((returnValue = cursor.GetBitsInt(bits, count, size)) == EOF)
+    {
+        return EOF;
+    }
+
+    m_BitPos += count;
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : GetVarint
+*   Description: This method reads an unsigned LEB128 varint, the format
+*                written by bit_file_c::PutVarint.  Nothing is read unless
+*                the whole varint is available.
+*   Parameters : value - address to store the value read
+*   Effects    : Moves the read position past the varint if it was
+*                available.
+*   Returned   : The number of bytes read, BF_NEED_MORE_DATA, or EOF (also
+*                for a varint longer than 10 bytes).
+***************************************************************************/
+int bit_push_reader_c::GetVarint(uint64_t *value)
+{
+    uint64_t result;
+    int c, i;
+
+    if (value == NULL)
+    {
+        return EOF;
+    }
+
+    bit_cursor_c cursor(m_Data.empty() ? NULL : &m_Data[0], m_Data.size(),
+        m_BitPos);
+    result = 0;
+
+    for (i = 0; i < BF_VARINT_MAX; i++)
+    {
+        if ((c = cursor.GetChar()) == EOF)
+        {
+            return Short();
+        }
+
+        result |= (uint64_t)(c & 0x7F) << (7 * i);
+
+        if (0 == (c & 0x80))
+        {
+            *value = result;
+            m_BitPos += 8 * (i + 1);
+            return i + 1;
+        }
+    }
+
+    return EOF;
+}
+
+/***************************************************************************
+*   Method     : GetVarintSigned
+*   Description: This method reads a zigzag encoded signed LEB128 varint,
+*                the format written by bit_file_c::PutVarintSigned.
+*   Parameters : value - address to store the value read
+*   Effects    : Moves the read position past the varint if it was
+*                available.
+*   Returned   : The number of bytes read, BF_NEED_MORE_DATA, or EOF.
+***************************************************************************/
+int bit_push_reader_c::GetVarintSigned(int64_t *value)
+{
+    uint64_t u;
+    int returnValue;
+
+    if (value == NULL)
+    {
+        return EOF;
+    }
+
+    returnValue = GetVarint(&u);
+
+    if (returnValue > 0)
+    {
+        *value = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+    }
+
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : Available
+*   Description: This method returns the number of bits that have been fed
+*                but not read.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of unread bits.
+***************************************************************************/
+uint64_t bit_push_reader_c::Available(void) const
+{
+    return ((uint64_t)m_Data.size() * 8) - m_BitPos;
+}
+
+/***************************************************************************
+*   Method     : Tell
+*   Description: This method returns the number of bits read since the
+*                reader was created.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Bit position of the next bit to be read.
+***************************************************************************/
+uint64_t bit_push_reader_c::Tell(void) const
+{
+    return (m_Consumed * 8) + m_BitPos;
+}
+
+/***************************************************************************
+*   Method     : eof
+*   Description: This method indicates whether every bit has been read and
+*                no more will be fed.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : true after Finish() once all bits are read, otherwise
+*                false.
+***************************************************************************/
+bool bit_push_reader_c::eof(void) const
+{
+    return m_Finished && (Available() == 0);
+}
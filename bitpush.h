@@ -0,0 +1,99 @@
+/***************************************************************************
+*                      Push Mode (Resumable) Bit Reader Header
+*
+*   File    : bitpush.h
+*   Purpose : Provides definitions and prototypes for a bit reader that is
+*             given its input a chunk at a time with Feed(), for data that
+*             arrives from non-blocking sockets and pipes.  A read that
+*             would run past the data fed so far returns BF_NEED_MORE_DATA
+*             and consumes nothing, so the same read can simply be retried
+*             after the next Feed().  Once Finish() says no more data is
+*             coming, such reads return EOF instead.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITPUSH_H
+#define __BITPUSH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+#define BF_NEED_MORE_DATA   (-2)    /* read needs data not fed yet */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+class bit_push_reader_c
+{
+    public:
+        bit_push_reader_c(void);
+
+        /* add the next chunk of input (copied) */
+        int Feed(const void *data, const size_t size);
+
+        /* no more input will be fed */
+        void Finish(void);
+
+        /* toss spare bits and byte align */
+        int ByteAlign(void);
+
+        /* get character */
+        int GetChar(void);
+
+        /* get single bit */
+        int GetBit(void);
+
+        /* get number of bits */
+        int64_t GetBits(void *bits, const uint64_t count);
+
+        /* get number of bits into integer types (short, int, ...) */
+        int GetBitsInt(void *bits, const unsigned int count,
+            const size_t size);
+
+        /* get LEB128 varints, unsigned and zigzag signed */
+        int GetVarint(uint64_t *value);
+        int GetVarintSigned(int64_t *value);
+
+        /* bits fed but not read yet, and bits read so far */
+        uint64_t Available(void) const;
+        uint64_t Tell(void) const;
+
+        /* status */
+        bool eof(void) const;
+
+    private:
+        std::vector<unsigned char> m_Data;  /* unread input */
+        uint64_t m_BitPos;              /* next bit to read in m_Data */
+        uint64_t m_Consumed;            /* bytes dropped from m_Data */
+        bool m_Finished;                /* Finish() has been called */
+
+        int Short(void) const;
+};
+
+#endif  /* ndef __BITPUSH_H */
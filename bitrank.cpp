@@ -0,0 +1,790 @@
+/***************************************************************************
+*                   Rank/Select Bit Index Implementation
+*
+*   File    : bitrank.cpp
+*   Purpose : This file implements classes that build and query a rank9
+*             style rank/select directory for a bit file.  The builder
+*             makes a single pass over the data counting the 1 bits in
+*             each 64 bit word with the popcnt instruction when the
+*             processor has it.  Queries read the directory and at most
+*             one word of the mapped bit file, so Rank1 takes constant
+*             time and Select1 a short search between two samples.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#include "bitrank.h"
+#include "bitcpu.h"
+
+using namespace std;
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+#if defined(__x86_64__) || defined(__i386__)
+#define BITRANK_X86
+#endif
+
+/* first word of a directory file ("BFRANK9" and a version byte) */
+#define BF_RANK_MAGIC       0x01394B4E41524642ULL
+
+/* words in the directory header */
+#define BF_RANK_HEADER      5
+
+/* bytes read at a time by AddFile */
+#define BF_RANK_CHUNK       (1 << 20)
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+/* counts the 1 bits in each of the 8 words of a block */
+typedef void (*count_words_t)(const unsigned char *block,
+    unsigned int *counts);
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : PopCount
+*   Description: This function counts the 1 bits in a word without any
+*                special instructions.
+*   Parameters : word - the word to count
+*   Effects    : None
+*   Returned   : The number of 1 bits in word.
+***************************************************************************/
+static inline unsigned int PopCount(uint64_t word)
+{
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) +
+        ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (unsigned int)((word * 0x0101010101010101ULL) >> 56);
+}
+
+/***************************************************************************
+*   Function   : CountWordsSoftware
+*   Description: This function counts the 1 bits in each word of a block
+*                with PopCount.  Byte order doesn't change a word's count,
+*                so the words are loaded in host order.
+*   Parameters : block - BF_RANK_BLOCK_BYTES bytes
+*                counts - array of 8 counts to fill in
+*   Effects    : Fills in counts.
+*   Returned   : None
+***************************************************************************/
+static void CountWordsSoftware(const unsigned char *block,
+    unsigned int *counts)
+{
+    uint64_t word;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        memcpy(&word, block + (8 * i), sizeof(word));
+        counts[i] = PopCount(word);
+    }
+}
+
+#ifdef BITRANK_X86
+/***************************************************************************
+*   Function   : CountWordsPopcnt
+*   Description: This function counts the 1 bits in each word of a block
+*                with the popcnt instruction.
+*   Parameters : block - BF_RANK_BLOCK_BYTES bytes
+*                counts - array of 8 counts to fill in
+*   Effects    : Fills in counts.
+*   Returned   : None
+***************************************************************************/
+__attribute__((target("popcnt")))
+static void CountWordsPopcnt(const unsigned char *block,
+    unsigned int *counts)
+{
+    uint64_t word;
+    int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        memcpy(&word, block + (8 * i), sizeof(word));
+        counts[i] = (unsigned int)__builtin_popcountll(word);
+    }
+}
+#endif
+
+/***************************************************************************
+*   Function   : CountWordsSelect
+*   Description: This function selects the fastest block counting function
+*                supported by the processor.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Pointer to the counting function.
+***************************************************************************/
+static count_words_t CountWordsSelect(void)
+{
+#ifdef BITRANK_X86
+    if (BitCpuFeatures() & BF_CPU_POPCNT)
+    {
+        return CountWordsPopcnt;
+    }
+#endif
+
+    return CountWordsSoftware;
+}
+
+/***************************************************************************
+*                        bit_rank_builder_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_rank_builder_c - constructor
+*   Description: This is the bit_rank_builder_c constructor.  It creates a
+*                builder that hasn't seen any data.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_rank_builder_c::bit_rank_builder_c(void)
+{
+    Reset();
+}
+
+/***************************************************************************
+*   Method     : Reset
+*   Description: This method discards everything added so the builder can
+*                index another file.
+*   Parameters : None
+*   Effects    : Empties the directory.
+*   Returned   : None
+***************************************************************************/
+void bit_rank_builder_c::Reset(void)
+{
+    m_Blocks.clear();
+    m_Samples.clear();
+    m_PendingLen = 0;
+    m_Bytes = 0;
+    m_Ones = 0;
+}
+
+/***************************************************************************
+*   Method     : AddBlock
+*   Description: This method adds the directory entries for a block.
+*   Parameters : block - BF_RANK_BLOCK_BYTES bytes
+*   Effects    : Appends to m_Blocks and m_Samples and updates m_Ones.
+*   Returned   : None
+***************************************************************************/
+void bit_rank_builder_c::AddBlock(const unsigned char *block)
+{
+    static const count_words_t countWords = CountWordsSelect();
+    unsigned int counts[8];
+    uint64_t sub, total;
+    int i;
+
+    countWords(block, counts);
+
+    /* 9 bit counts before words 1 through 7 */
+    sub = 0;
+    total = 0;
+
+    for (i = 0; i < 8; i++)
+    {
+        if (i != 0)
+        {
+            sub |= total << (9 * (i - 1));
+        }
+
+        total += counts[i];
+    }
+
+    /* sample the block holding every BF_RANK_SAMPLEth 1 */
+    while ((uint64_t)m_Samples.size() * BF_RANK_SAMPLE < m_Ones + total)
+    {
+        m_Samples.push_back(m_Blocks.size() / 2);
+    }
+
+    m_Blocks.push_back(m_Ones);
+    m_Blocks.push_back(sub);
+    m_Ones += total;
+}
+
+/***************************************************************************
+*   Method     : Add
+*   Description: This method adds the next bytes of the bit file to the
+*                directory.  Bytes may be added in pieces of any size.
+*   Parameters : data - the bytes to add
+*                size - number of bytes in data
+*   Effects    : Updates the directory.
+*   Returned   : EOF if data is NULL, otherwise 0.
+***************************************************************************/
+int bit_rank_builder_c::Add(const void *data, const size_t size)
+{
+    const unsigned char *bytes;
+    size_t remaining, length;
+
+    if ((data == NULL) && (size != 0))
+    {
+        return EOF;
+    }
+
+    bytes = (const unsigned char *)data;
+    remaining = size;
+    m_Bytes += size;
+
+    if (m_PendingLen != 0)
+    {
+        /* finish the partial block first */
+        length = BF_RANK_BLOCK_BYTES - m_PendingLen;
+
+        if (length > remaining)
+        {
+            length = remaining;
+        }
+
+        memcpy(m_Pending + m_PendingLen, bytes, length);
+        m_PendingLen += (unsigned int)length;
+        bytes += length;
+        remaining -= length;
+
+        if (m_PendingLen < BF_RANK_BLOCK_BYTES)
+        {
+            return 0;
+        }
+
+        AddBlock(m_Pending);
+        m_PendingLen = 0;
+    }
+
+    while (remaining >= BF_RANK_BLOCK_BYTES)
+    {
+        AddBlock(bytes);
+        bytes += BF_RANK_BLOCK_BYTES;
+        remaining -= BF_RANK_BLOCK_BYTES;
+    }
+
+    if (remaining != 0)
+    {
+        memcpy(m_Pending, bytes, remaining);
+        m_PendingLen = (unsigned int)remaining;
+    }
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : AddFile
+*   Description: This method reads a whole file and adds it to the
+*                directory.
+*   Parameters : fileName - NULL terminated string containing the name of
+*                           the bit file.
+*   Effects    : Updates the directory.
+*   Returned   : EOF if the file can't be read, otherwise 0.
+***************************************************************************/
+int bit_rank_builder_c::AddFile(const char *fileName)
+{
+    vector<unsigned char> chunk(BF_RANK_CHUNK);
+    ssize_t result;
+    int fd;
+
+    fd = open(fileName, O_RDONLY);
+
+    if (fd < 0)
+    {
+        return EOF;
+    }
+
+    while ((result = read(fd, &chunk[0], chunk.size())) != 0)
+    {
+        if (result < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            close(fd);
+            return EOF;
+        }
+
+        Add(&chunk[0], (size_t)result);
+    }
+
+    close(fd);
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Write
+*   Description: This method writes the directory for the bytes added so
+*                far.  A partial last block is treated as if it were
+*                padded with 0 bits.  More bytes may still be added
+*                afterwards.
+*   Parameters : indexFileName - NULL terminated string containing the
+*                                name of the directory file.
+*   Effects    : Creates or replaces the directory file.
+*   Returned   : EOF for failure, otherwise 0.
+***************************************************************************/
+int bit_rank_builder_c::Write(const char *indexFileName)
+{
+    size_t blocks, samples;
+    uint64_t ones, header[BF_RANK_HEADER];
+
+    blocks = m_Blocks.size();
+    samples = m_Samples.size();
+    ones = m_Ones;
+
+    if (m_PendingLen != 0)
+    {
+        unsigned char block[BF_RANK_BLOCK_BYTES];
+
+        memset(block, 0, sizeof(block));
+        memcpy(block, m_Pending, m_PendingLen);
+        AddBlock(block);
+    }
+
+    header[0] = BF_RANK_MAGIC;
+    header[1] = m_Bytes * 8;
+    header[2] = m_Ones;
+    header[3] = m_Blocks.size() / 2;
+    header[4] = m_Samples.size();
+
+    ofstream out(indexFileName, ios::out | ios::binary | ios::trunc);
+
+    out.write((const char *)header, sizeof(header));
+
+    if (!m_Blocks.empty())
+    {
+        out.write((const char *)&m_Blocks[0],
+            m_Blocks.size() * sizeof(uint64_t));
+    }
+
+    if (!m_Samples.empty())
+    {
+        out.write((const char *)&m_Samples[0],
+            m_Samples.size() * sizeof(uint64_t));
+    }
+
+    out.close();
+
+    /* take the padded block back out */
+    m_Blocks.resize(blocks);
+    m_Samples.resize(samples);
+    m_Ones = ones;
+
+    return out.fail() ? EOF : 0;
+}
+
+/***************************************************************************
+*   Method     : Bits
+*   Description: This method returns the number of bits added.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of bits added.
+***************************************************************************/
+uint64_t bit_rank_builder_c::Bits(void) const
+{
+    return m_Bytes * 8;
+}
+
+/***************************************************************************
+*   Method     : Ones
+*   Description: This method returns the number of 1 bits added.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of 1 bits added.
+***************************************************************************/
+uint64_t bit_rank_builder_c::Ones(void) const
+{
+    uint64_t ones;
+    unsigned int i;
+
+    ones = m_Ones;
+
+    for (i = 0; i < m_PendingLen; i++)
+    {
+        ones += PopCount(m_Pending[i]);
+    }
+
+    return ones;
+}
+
+/***************************************************************************
+*                        bit_rank_index_c METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_rank_index_c - default constructor
+*   Description: This is the default bit_rank_index_c constructor.  It
+*                creates an object without a directory.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_rank_index_c::bit_rank_index_c(void)
+{
+    m_Data = NULL;
+    m_Bits = 0;
+    m_Ones = 0;
+    m_BlockCount = 0;
+    m_SampleCount = 0;
+    m_Blocks = NULL;
+    m_Samples = NULL;
+}
+
+/***************************************************************************
+*   Method     : bit_rank_index_c - constructor
+*   Description: This is a bit_rank_index_c constructor.  It maps the
+*                directory for a mapped bit file.  An exception will be
+*                thrown on error.
+*   Parameters : bits - the mapped bit file
+*                indexFileName - NULL terminated string containing the
+*                                name of the directory file.
+*   Effects    : Initializes private members and maps the directory.
+*   Returned   : None
+***************************************************************************/
+bit_rank_index_c::bit_rank_index_c(const bit_mapping_c &bits,
+    const char *indexFileName)
+{
+    m_Data = NULL;
+    m_Bits = 0;
+    m_Ones = 0;
+    m_BlockCount = 0;
+    m_SampleCount = 0;
+    m_Blocks = NULL;
+    m_Samples = NULL;
+
+    Open(bits, indexFileName);
+}
+
+/***************************************************************************
+*   Method     : ~bit_rank_index_c - destructor
+*   Description: This is the bit_rank_index_c destructor.  It unmaps the
+*                directory.
+*   Parameters : None
+*   Effects    : Unmaps the directory.
+*   Returned   : None
+***************************************************************************/
+bit_rank_index_c::~bit_rank_index_c(void)
+{
+    Close();
+}
+
+/***************************************************************************
+*   Method     : Open
+*   Description: This method maps a directory and checks that it was built
+*                for a bit file of the mapped size, and that its counts and
+*                select samples are consistent.  The bit file mapping
+*                must outlive the index.  An exception will be thrown on
+*                error.
+*   Parameters : bits - the mapped bit file
+*                indexFileName - NULL terminated string containing the
+*                                name of the directory file.
+*   Effects    : Maps the directory.
+*   Returned   : None
+*   Exception  : "Error: File Already Open" - if object has a directory
+*                "Error: Unable To Open File" - if file cannot be mapped
+*                "Error: Invalid Index" - if the directory doesn't match
+***************************************************************************/
+void bit_rank_index_c::Open(const bit_mapping_c &bits,
+    const char *indexFileName)
+{
+    const uint64_t *header, *samples;
+    uint64_t size, i;
+
+    if (m_Blocks != NULL)
+    {
+        throw("Error: File Already Open");
+    }
+
+    m_Index.Open(indexFileName);
+    header = (const uint64_t *)m_Index.Data();
+    size = m_Index.Size();
+
+    if ((size < BF_RANK_HEADER * sizeof(uint64_t)) ||
+        (header[0] != BF_RANK_MAGIC) ||
+        (header[1] != bits.Bits()) ||
+        (header[3] != (bits.Size() + BF_RANK_BLOCK_BYTES - 1) /
+            BF_RANK_BLOCK_BYTES) ||
+        (header[2] > header[1]) ||
+        (header[4] != (header[2] + BF_RANK_SAMPLE - 1) / BF_RANK_SAMPLE) ||
+        (size != (BF_RANK_HEADER + (2 * header[3]) + header[4]) *
+            sizeof(uint64_t)))
+    {
+        m_Index.Close();
+        throw("Error: Invalid Index");
+    }
+
+    /* Select1 indexes the blocks with the samples */
+    samples = header + BF_RANK_HEADER + (2 * header[3]);
+
+    for (i = 0; i < header[4]; i++)
+    {
+        if (samples[i] >= header[3])
+        {
+            m_Index.Close();
+            throw("Error: Invalid Index");
+        }
+    }
+
+    m_Data = bits.Data();
+    m_Bits = header[1];
+    m_Ones = header[2];
+    m_BlockCount = header[3];
+    m_SampleCount = header[4];
+    m_Blocks = header + BF_RANK_HEADER;
+    m_Samples = m_Blocks + (2 * m_BlockCount);
+}
+
+/***************************************************************************
+*   Method     : Close
+*   Description: This method unmaps the directory.
+*   Parameters : None
+*   Effects    : Unmaps the directory.
+*   Returned   : None
+***************************************************************************/
+void bit_rank_index_c::Close(void)
+{
+    m_Index.Close();
+    m_Data = NULL;
+    m_Bits = 0;
+    m_Ones = 0;
+    m_BlockCount = 0;
+    m_SampleCount = 0;
+    m_Blocks = NULL;
+    m_Samples = NULL;
+}
+
+/***************************************************************************
+*   Method     : Word
+*   Description: This method loads a 64 bit word of the bit file with its
+*                first bit in the msb.  Bytes past the end read as 0.
+*   Parameters : word - index of the word
+*   Effects    : None
+*   Returned   : The word.
+***************************************************************************/
+uint64_t bit_rank_index_c::Word(const uint64_t word) const
+{
+    uint64_t value, first, i;
+
+    value = 0;
+    first = word * 8;
+
+    for (i = first; i < first + 8; i++)
+    {
+        value <<= 8;
+
+        if (i < m_Bits / 8)
+        {
+            value |= m_Data[i];
+        }
+    }
+
+    return value;
+}
+
+/***************************************************************************
+*   Method     : SubCount
+*   Description: This method returns the number of 1 bits in a block that
+*                come before one of its words.
+*   Parameters : block - index of the block
+*                word - word in the block (0 - 7)
+*   Effects    : None
+*   Returned   : Number of 1 bits.
+***************************************************************************/
+uint64_t bit_rank_index_c::SubCount(const uint64_t block,
+    const unsigned int word) const
+{
+    if (0 == word)
+    {
+        return 0;
+    }
+
+    return (m_Blocks[(2 * block) + 1] >> (9 * (word - 1))) & 0x1FF;
+}
+
+/***************************************************************************
+*   Method     : Rank1
+*   Description: This method returns the number of 1 bits before a bit
+*                position.
+*   Parameters : position - bit position (positions past the end count
+*                           every 1 bit)
+*   Effects    : None
+*   Returned   : Number of 1 bits before position.
+***************************************************************************/
+uint64_t bit_rank_index_c::Rank1(const uint64_t position) const
+{
+    uint64_t word, rank;
+    unsigned int bits;
+
+    if (position >= m_Bits)
+    {
+        return m_Ones;
+    }
+
+    word = position / 64;
+    rank = m_Blocks[2 * (word / 8)] + SubCount(word / 8, word % 8);
+    bits = position % 64;
+
+    if (bits != 0)
+    {
+        rank += PopCount(Word(word) >> (64 - bits));
+    }
+
+    return rank;
+}
+
+/***************************************************************************
+*   Method     : Rank0
+*   Description: This method returns the number of 0 bits before a bit
+*                position.
+*   Parameters : position - bit position (positions past the end count
+*                           every 0 bit)
+*   Effects    : None
+*   Returned   : Number of 0 bits before position.
+***************************************************************************/
+uint64_t bit_rank_index_c::Rank0(const uint64_t position) const
+{
+    uint64_t end;
+
+    end = (position < m_Bits) ? position : m_Bits;
+    return end - Rank1(end);
+}
+
+/***************************************************************************
+*   Method     : Select1
+*   Description: This method finds the position of 1 bit number k.  The
+*                samples bound the block holding it, a binary search of
+*                the block counts finds the block, and the 9 bit counts
+*                find the word.
+*   Parameters : k - number of the 1 bit, counting from 0
+*   Effects    : None
+*   Returned   : Bit position of the 1 bit, EOF if there are k or fewer
+*                1 bits.
+***************************************************************************/
+int64_t bit_rank_index_c::Select1(const uint64_t k) const
+{
+    uint64_t low, high, mid, rank, value;
+    unsigned int word, shift, count;
+
+    if (k >= m_Ones)
+    {
+        return EOF;
+    }
+
+    /* last block with a count <= k */
+    low = m_Samples[k / BF_RANK_SAMPLE];
+    high = ((k / BF_RANK_SAMPLE) + 1 < m_SampleCount) ?
+        m_Samples[(k / BF_RANK_SAMPLE) + 1] : m_BlockCount - 1;
+
+    while (low < high)
+    {
+        mid = low + ((high - low + 1) / 2);
+
+        if (m_Blocks[2 * mid] <= k)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid - 1;
+        }
+    }
+
+    rank = k - m_Blocks[2 * low];
+
+    for (word = 1; word < 8; word++)
+    {
+        if (SubCount(low, word) > rank)
+        {
+            break;
+        }
+    }
+
+    word--;
+    rank -= SubCount(low, word);
+    value = Word((low * 8) + word);
+
+    /* find the byte, then the bit */
+    for (shift = 56; ; shift -= 8)
+    {
+        count = PopCount((value >> shift) & 0xFF);
+
+        if (rank < count)
+        {
+            break;
+        }
+
+        rank -= count;
+    }
+
+    value = (value >> shift) & 0xFF;
+    count = 0;
+
+    while (1)
+    {
+        if (value & (0x80 >> count))
+        {
+            if (0 == rank)
+            {
+                break;
+            }
+
+            rank--;
+        }
+
+        count++;
+    }
+
+    return (int64_t)((((low * 8) + word) * 64) + (56 - shift) + count);
+}
+
+/***************************************************************************
+*   Method     : Bits
+*   Description: This method returns the number of indexed bits.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of indexed bits.
+***************************************************************************/
+uint64_t bit_rank_index_c::Bits(void) const
+{
+    return m_Bits;
+}
+
+/***************************************************************************
+*   Method     : Ones
+*   Description: This method returns the number of indexed 1 bits.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of 1 bits.
+***************************************************************************/
+uint64_t bit_rank_index_c::Ones(void) const
+{
+    return m_Ones;
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+*                       Rank/Select Bit Index Header
+*
+*   File    : bitrank.h
+*   Purpose : Provides definitions and prototypes for classes that build
+*             and query a rank/select directory for a bit file.  Rank1(i)
+*             is the number of 1 bits before bit i and Select1(k) is the
+*             position of 1 bit number k (counting from 0).  Bits are
+*             numbered in the order bit_file_c reads them, msb of the first
+*             byte first.
+*
+*             The directory uses the rank9 layout: for every 512 bit block
+*             a 64 bit count of the 1 bits before the block, and a 64 bit
+*             word packing the 9 bit counts before each of the block's
+*             other 7 words.  The block holding every 8192nd 1 bit is
+*             sampled to narrow the search done by Select1.
+*
+*             The directory file is written in host byte order so it can
+*             be mapped and used as is:
+*                 magic, bits, ones, blocks, samples (64 bits each)
+*                 2 words per block
+*                 1 word per sample
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITRANK_H
+#define __BITRANK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "bitcursor.h"
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+#define BF_RANK_BLOCK_BYTES     64      /* bytes covered by a block */
+#define BF_RANK_SAMPLE          8192    /* 1 bits between select samples */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+
+/* builds a rank/select directory in one pass over the data */
+class bit_rank_builder_c
+{
+    public:
+        bit_rank_builder_c(void);
+
+        /* add the next bytes of the bit file */
+        int Add(const void *data, const size_t size);
+
+        /* add a whole file */
+        int AddFile(const char *fileName);
+
+        /* write directory for the bytes added so far */
+        int Write(const char *indexFileName);
+        void Reset(void);
+
+        uint64_t Bits(void) const;
+        uint64_t Ones(void) const;
+
+    private:
+        std::vector<uint64_t> m_Blocks;     /* 2 words per block */
+        std::vector<uint64_t> m_Samples;    /* block of every sampled 1 */
+        unsigned char m_Pending[BF_RANK_BLOCK_BYTES];  /* partial block */
+        unsigned int m_PendingLen;          /* bytes in m_Pending */
+        uint64_t m_Bytes;                   /* bytes added */
+        uint64_t m_Ones;                    /* 1 bits in whole blocks */
+
+        void AddBlock(const unsigned char *block);
+};
+
+/* answers rank/select queries over a mapped bit file and its directory */
+class bit_rank_index_c
+{
+    public:
+        bit_rank_index_c(void);
+        bit_rank_index_c(const bit_mapping_c &bits,
+            const char *indexFileName);
+        virtual ~bit_rank_index_c(void);
+
+        /* map/unmap directory */
+        void Open(const bit_mapping_c &bits, const char *indexFileName);
+        void Close(void);
+
+        /* number of 1 (0) bits before bit position */
+        uint64_t Rank1(const uint64_t position) const;
+        uint64_t Rank0(const uint64_t position) const;
+
+        /* position of 1 bit number k (from 0), EOF if there is none */
+        int64_t Select1(const uint64_t k) const;
+
+        uint64_t Bits(void) const;
+        uint64_t Ones(void) const;
+
+    private:
+        const unsigned char *m_Data;    /* indexed bytes */
+        uint64_t m_Bits;                /* number of indexed bits */
+        uint64_t m_Ones;                /* number of 1 bits */
+        uint64_t m_BlockCount;          /* number of blocks */
+        uint64_t m_SampleCount;         /* number of select samples */
+        const uint64_t *m_Blocks;       /* 2 words per block */
+        const uint64_t *m_Samples;      /* block of every sampled 1 */
+        bit_mapping_c m_Index;          /* mapped directory */
+
+        uint64_t Word(const uint64_t word) const;
+        uint64_t SubCount(const uint64_t block,
+            const unsigned int word) const;
+};
+
+#endif  /* ndef __BITRANK_H */
@@ -0,0 +1,260 @@
+/***************************************************************************
+*                  Compile Time Bit Record Layout Header
+*
+*   File    : bitrecord.h
+*   Purpose : Provides bf_record_layout, a template describing a record of
+*             fixed width bit fields at compile time.  Put() and Get()
+*             expand into straight line code that packs every field into
+*             one accumulator word and hands it to a basic_bit_stream with
+*             a single PutBits (or takes it with a single GetBits).
+*             Records wider than the stream's MAX_BITS are split into as
+*             few words as the field boundaries allow.
+*
+*             Example:
+*                 struct hdr_t { unsigned ver, len; bool last; int off; };
+*
+*                 typedef bf_record_layout<hdr_t,
+*                     BF_FIELD(hdr_t, ver, 3),
+*                     BF_FIELD(hdr_t, len, 13),
+*                     BF_FIELD(hdr_t, last, 1),
+*                     BF_FIELD(hdr_t, off, 7)> hdr_layout;
+*
+*                 hdr_layout::Put(stream, header);
+*
+*             Fields are written in the order listed, first field first,
+*             exactly as the same sequence of PutBits calls would write
+*             them.  Signed members are sign extended when read.  Header
+*             only; requires C++17.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITRECORD_H
+#define __BITRECORD_H
+
+#if !defined(__cpp_if_constexpr) || (__cpp_if_constexpr < 201606L)
+#error "bitrecord.h requires C++17"
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include "bitstream.h"
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* field of width bits stored in record.member */
+#define BF_FIELD(record, member, width) \
+    bf_field<record, decltype(record::member), &record::member, width>
+
+/***************************************************************************
+*                                 FIELDS
+***************************************************************************/
+template <class Record, class T, T Record::*Member, unsigned int Width>
+struct bf_field
+{
+    static_assert((Width > 0) && (Width <= 64),
+        "bit field width must be 1 - 64");
+
+    static const unsigned int WIDTH = Width;
+    static const uint64_t MASK = (Width == 64) ? ~(uint64_t)0 :
+        (((uint64_t)1 << (Width % 64)) - 1);
+
+    /* member value as an unsigned Width bit value */
+    static inline uint64_t Get(const Record &record)
+    {
+        return (uint64_t)(record.*Member) & MASK;
+    }
+
+    /* set member from a Width bit value */
+    static inline void Set(Record &record, uint64_t value)
+    {
+        if constexpr (std::is_signed<T>::value && (Width < 64))
+        {
+            const uint64_t sign = (uint64_t)1 << (Width - 1);
+
+            value = (value ^ sign) - sign;
+        }
+
+        record.*Member = (T)value;
+    }
+};
+
+/***************************************************************************
+*                                 CODEC
+* bf_record_codec<Max, Used, Fields...> packs/unpacks Fields into words of
+* at most Max bits.  Used is the number of bits already in the current
+* word.  A word ends after a field when the next one would not fit.
+***************************************************************************/
+
+/* width of the first field, 0 if there are none */
+template <class... Fields>
+struct bf_first_width
+{
+    static const unsigned int VALUE = 0;
+};
+
+template <class F, class... Rest>
+struct bf_first_width<F, Rest...>
+{
+    static const unsigned int VALUE = F::WIDTH;
+};
+
+template <unsigned int Max, unsigned int Used, class... Fields>
+struct bf_record_codec
+{
+    static const unsigned int WORD = Used;  /* bits in the current word */
+
+    template <class Stream, class Record, class A>
+    static inline int Put(Stream &, const Record &, A)
+    {
+        return 0;
+    }
+
+    template <class Stream, class Record, class A>
+    static inline int Get(Stream &, Record &, A)
+    {
+        return 0;
+    }
+};
+
+template <unsigned int Max, unsigned int Used, class F, class... Rest>
+struct bf_record_codec<Max, Used, F, Rest...>
+{
+    static_assert(F::WIDTH <= Max,
+        "bit field is wider than the stream's MAX_BITS");
+
+    /* bits in the current word after F, and whether F ends the word */
+    static const unsigned int END = Used + F::WIDTH;
+    static const bool LAST = (0 == sizeof...(Rest)) ||
+        (END + bf_first_width<Rest...>::VALUE > Max);
+
+    typedef bf_record_codec<Max, (LAST ? 0 : END), Rest...> next_t;
+
+    /* total bits in the current word */
+    static const unsigned int WORD = LAST ? END : next_t::WORD;
+
+    template <class Stream, class Record, class A>
+    static inline int Put(Stream &stream, const Record &record, A acc)
+    {
+        acc = (acc << (F::WIDTH % (8 * sizeof(A)))) | (A)F::Get(record);
+
+        if constexpr (LAST)
+        {
+            if (stream.PutBits(acc, END) == EOF)
+            {
+                return EOF;
+            }
+
+            return next_t::Put(stream, record, (A)0);
+        }
+        else
+        {
+            return next_t::Put(stream, record, acc);
+        }
+    }
+
+    template <class Stream, class Record, class A>
+    static inline int Get(Stream &stream, Record &record, A acc)
+    {
+        if constexpr (0 == Used)
+        {
+            if (stream.GetBits(&acc, WORD) == EOF)
+            {
+                return EOF;
+            }
+        }
+
+        F::Set(record, (uint64_t)(acc >> (WORD - END)) & F::MASK);
+        return next_t::Get(stream, record, acc);
+    }
+};
+
+/***************************************************************************
+*                              RECORD LAYOUT
+***************************************************************************/
+template <class Record, class... Fields>
+class bf_record_layout
+{
+    public:
+        /* bits in one record */
+        static const unsigned int BITS = (0 + ... + Fields::WIDTH);
+
+        /* write one record */
+        template <class Stream>
+        static inline int Put(Stream &stream, const Record &record)
+        {
+            return codec_t<Stream>::Put(stream, record,
+                (typename Stream::accumulator_t)0);
+        }
+
+        /* read one record.  fields read before an EOF are changed. */
+        template <class Stream>
+        static inline int Get(Stream &stream, Record *record)
+        {
+            return codec_t<Stream>::Get(stream, *record,
+                (typename Stream::accumulator_t)0);
+        }
+
+        /* write count records; returns count or EOF */
+        template <class Stream>
+        static int64_t PutArray(Stream &stream, const Record *records,
+            const size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (Put(stream, records[i]) == EOF)
+                {
+                    return EOF;
+                }
+            }
+
+            return (int64_t)count;
+        }
+
+        /* read up to count records; returns the number of whole records */
+        template <class Stream>
+        static size_t GetArray(Stream &stream, Record *records,
+            const size_t count)
+        {
+            size_t i;
+
+            for (i = 0; i < count; i++)
+            {
+                if (Get(stream, &records[i]) == EOF)
+                {
+                    break;
+                }
+            }
+
+            return i;
+        }
+
+    private:
+        template <class Stream>
+        using codec_t = bf_record_codec<Stream::MAX_BITS, 0, Fields...>;
+};
+
+#endif  /* ndef __BITRECORD_H */
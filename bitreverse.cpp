@@ -0,0 +1,312 @@
+/***************************************************************************
+*                Reverse (End To Start) Bit Reader Implementation
+*
+*   File    : bitreverse.cpp
+*   Purpose : This file implements a class that reads a bit stream from
+*             its last bit to its first.  The end of the stream is marked
+*             by a sentinel 1 bit followed only by 0 bits of padding, so
+*             the reader can find the last data bit of a stream that
+*             doesn't end on a byte boundary.  A 64 bit accumulator is
+*             refilled from decreasing addresses, a word at a time when
+*             possible.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include "bitreverse.h"
+#include "bitcursor.h"
+
+/***************************************************************************
+*                                 METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_reverse_reader_c - default constructor
+*   Description: This is the default bit_reverse_reader_c constructor.  It
+*                creates a reader with no bits to read.
+*   Parameters : None
+*   Effects    : Initializes private members.
+*   Returned   : None
+***************************************************************************/
+bit_reverse_reader_c::bit_reverse_reader_c(void)
+{
+    m_Data = NULL;
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+}
+
+/***************************************************************************
+*   Method     : bit_reverse_reader_c - constructor
+*   Description: This is a bit_reverse_reader_c constructor for reading a
+*                mapped file backwards.  The mapping must outlive the
+*                reader.  An exception will be thrown on error.
+*   Parameters : mapping - the mapped file to read
+*   Effects    : Initializes private members and finds the sentinel bit.
+*   Returned   : None
+*   Exception  : "Error: Missing Sentinel Bit" - if the file has no 1 bits
+***************************************************************************/
+bit_reverse_reader_c::bit_reverse_reader_c(const bit_mapping_c &mapping)
+{
+    m_Data = NULL;
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    if (Open(mapping.Data(), mapping.Size()) == EOF)
+    {
+        throw("Error: Missing Sentinel Bit");
+    }
+}
+
+/***************************************************************************
+*   Method     : bit_reverse_reader_c - constructor
+*   Description: This is a bit_reverse_reader_c constructor for reading
+*                memory backwards.  The memory must outlive the reader.  An
+*                exception will be thrown on error.
+*   Parameters : data - the bytes to read
+*                size - number of bytes in data
+*   Effects    : Initializes private members and finds the sentinel bit.
+*   Returned   : None
+*   Exception  : "Error: Missing Sentinel Bit" - if data has no 1 bits
+***************************************************************************/
+bit_reverse_reader_c::bit_reverse_reader_c(const void *data,
+    const uint64_t size)
+{
+    m_Data = NULL;
+    m_Next = 0;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    if (Open(data, size) == EOF)
+    {
+        throw("Error: Missing Sentinel Bit");
+    }
+}
+
+/***************************************************************************
+*   Method     : Open
+*   Description: This method prepares to read data backwards.  Trailing
+*                zero bytes are skipped, then the last 1 bit (the sentinel)
+*                is found and discarded along with the 0 bits after it.
+*                The bit before the sentinel is the first bit returned.
+*   Parameters : data - the bytes to read
+*                size - number of bytes in data
+*   Effects    : Initializes private members.
+*   Returned   : EOF if there is no sentinel bit, otherwise 0.
+***************************************************************************/
+int bit_reverse_reader_c::Open(const void *data, const uint64_t size)
+{
+    unsigned char last;
+
+    m_Data = (const unsigned char *)data;
+    m_Next = size;
+    m_BitBuffer = 0;
+    m_BitCount = 0;
+
+    while ((m_Next > 0) && (0 == m_Data[m_Next - 1]))
+    {
+        m_Next--;
+    }
+
+    if (0 == m_Next)
+    {
+        return EOF;
+    }
+
+    /* bits before the sentinel in the last byte */
+    m_Next--;
+    last = m_Data[m_Next];
+    m_BitCount = 7 - __builtin_ctz(last);
+    m_BitBuffer = last >> (8 - m_BitCount);
+
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Fill
+*   Description: This method loads the bytes before the unread part of the
+*                bit buffer into its msbs until it holds at least 56 bits
+*                or the start of the data is reached.  When 8 bytes are
+*                available they are loaded with a single read.
+*   Parameters : None
+*   Effects    : Updates the bit buffer and m_Next.
+*   Returned   : None
+***************************************************************************/
+void bit_reverse_reader_c::Fill(void)
+{
+    unsigned int bytes;
+
+    if (m_Next >= 8)
+    {
+        uint64_t word;
+        int i;
+
+        /* bytes is at most 7, so the shifts are always less than 64 */
+        bytes = (63 - m_BitCount) / 8;
+
+        if (0 == bytes)
+        {
+            return;
+        }
+
+        word = 0;
+
+        for (i = 8; i > 0; i--)
+        {
+            word = (word << 8) | m_Data[m_Next - i];
+        }
+
+        /* the last (bytes) bytes of the word go above the buffered bits */
+        word &= ((uint64_t)1 << (bytes * 8)) - 1;
+        m_BitBuffer |= word << m_BitCount;
+        m_BitCount += bytes * 8;
+        m_Next -= bytes;
+        return;
+    }
+
+    while ((m_BitCount <= 56) && (m_Next > 0))
+    {
+        m_Next--;
+        m_BitBuffer |= (uint64_t)m_Data[m_Next] << m_BitCount;
+        m_BitCount += 8;
+    }
+}
+
+/***************************************************************************
+*   Method     : GetBit
+*   Description: This method returns the last unread bit.
+*   Parameters : None
+*   Effects    : Moves the read position back 1 bit.
+*   Returned   : 0 if bit == 0, 1 if bit == 1, and EOF if operation fails.
+***************************************************************************/
+int bit_reverse_reader_c::GetBit(void)
+{
+    int returnValue;
+
+    if (0 == m_BitCount)
+    {
+        Fill();
+
+        if (0 == m_BitCount)
+        {
+            return EOF;
+        }
+    }
+
+    returnValue = (int)(m_BitBuffer & 0x01);
+    m_BitBuffer >>= 1;
+    m_BitCount--;
+
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : PeekBits
+*   Description: This method returns the last count unread bits without
+*                reading them.  The bits are returned in the order they
+*                were written, right justified.
+*   Parameters : value - address to store bits
+*                count - number of bits (BF_REVERSE_MAX_BITS or fewer)
+*   Effects    : May refill the bit buffer.
+*   Returned   : EOF if count is too large or fewer than count bits
+*                remain, otherwise count.
+***************************************************************************/
+int bit_reverse_reader_c::PeekBits(uint64_t *value, const unsigned int count)
+{
+    if ((value == NULL) || (count > BF_REVERSE_MAX_BITS))
+    {
+        return EOF;
+    }
+
+    if (m_BitCount < count)
+    {
+        Fill();
+
+        if (m_BitCount < count)
+        {
+            return EOF;
+        }
+    }
+
+    *value = m_BitBuffer & (((uint64_t)1 << count) - 1);
+    return count;
+}
+
+/***************************************************************************
+*   Method     : GetBits
+*   Description: This method reads the last count unread bits.  The bits
+*                are returned in the order they were written, right
+*                justified, so a field written msb first (e.g. with PutBits
+*                from a big endian value) is read back with the same
+*                value.
+*   Parameters : value - address to store bits read
+*                count - number of bits (BF_REVERSE_MAX_BITS or fewer)
+*   Effects    : Moves the read position back count bits.
+*   Returned   : EOF if count is too large or fewer than count bits
+*                remain, otherwise count.
+***************************************************************************/
+int bit_reverse_reader_c::GetBits(uint64_t *value, const unsigned int count)
+{
+    if (PeekBits(value, count) == EOF)
+    {
+        return EOF;
+    }
+
+    /* count may be 0, but is always less than 64 */
+    m_BitBuffer >>= count;
+    m_BitCount -= count;
+
+    return count;
+}
+
+/***************************************************************************
+*   Method     : Remaining
+*   Description: This method returns the number of bits that haven't been
+*                read.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Number of unread bits.
+***************************************************************************/
+uint64_t bit_reverse_reader_c::Remaining(void) const
+{
+    return (m_Next * 8) + m_BitCount;
+}
+
+/***************************************************************************
+*   Method     : eof
+*   Description: This method indicates whether or not every bit has been
+*                read.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Returns true if there are no bits left to read.
+***************************************************************************/
+bool bit_reverse_reader_c::eof(void) const
+{
+    return ((0 == m_BitCount) && (0 == m_Next));
+}
@@ -0,0 +1,87 @@
+/***************************************************************************
+*                    Reverse (End To Start) Bit Reader Header
+*
+*   File    : bitreverse.h
+*   Purpose : Provides definitions and prototypes for a class that reads a
+*             bit stream backwards, starting from its last bit.  Entropy
+*             coders such as tANS/FSE encode symbols in reverse so that the
+*             decoder can read them back from the end of the stream.  A
+*             stream written forward with bit_file_c and terminated by a
+*             single 1 bit (the sentinel) before being closed can be read
+*             with this class; each GetBits(n) returns the last n bits that
+*             have not been read yet as an integer whose msb is the first
+*             of those bits.  Fields come back last in, first out.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITREVERSE_H
+#define __BITREVERSE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class bit_mapping_c;
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+#define BF_REVERSE_MAX_BITS     56      /* most bits per GetBits/PeekBits */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+class bit_reverse_reader_c
+{
+    public:
+        bit_reverse_reader_c(void);
+        bit_reverse_reader_c(const bit_mapping_c &mapping);
+        bit_reverse_reader_c(const void *data, const uint64_t size);
+
+        /* start reading data from its sentinel bit */
+        int Open(const void *data, const uint64_t size);
+
+        /* get single bit */
+        int GetBit(void);
+
+        /* get/look at up to BF_REVERSE_MAX_BITS bits, right justified */
+        int GetBits(uint64_t *value, const unsigned int count);
+        int PeekBits(uint64_t *value, const unsigned int count);
+
+        /* number of bits that haven't been read */
+        uint64_t Remaining(void) const;
+
+        /* status */
+        bool eof(void) const;
+
+    private:
+        const unsigned char *m_Data;    /* bytes being read */
+        uint64_t m_Next;                /* bytes before m_Next are unread */
+        uint64_t m_BitBuffer;           /* bits waiting to be read (lsbs) */
+        unsigned char m_BitCount;       /* number of bits in bitBuffer */
+
+        void Fill(void);
+};
+
+#endif  /* ndef __BITREVERSE_H */
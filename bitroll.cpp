@@ -0,0 +1,483 @@
+/***************************************************************************
+*                   Rolling Segment Writer Implementation
+*
+*   File    : bitroll.cpp
+*   Purpose : This file implements bit_rolling_writer_c.  The encoding
+*             thread only swaps in a segment the worker thread has already
+*             opened and hands the finished one back to be flushed and
+*             closed.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bitroll.h"
+#include "bitcursor.h"
+
+using namespace std;
+
+/***************************************************************************
+*                                 MACROS
+***************************************************************************/
+/* bytes moved at a time when a write is split at an unaligned bit */
+#define BF_ROLL_BLOCK   4096
+
+/***************************************************************************
+*                                METHODS
+***************************************************************************/
+
+/***************************************************************************
+*   Method     : bit_rolling_writer_c - constructor
+*   Description: This method opens the first segment and starts the
+*                worker thread, which opens the second.
+*   Parameters : baseName - segment file names are baseName.NNNNNN
+*                segmentBits - bits per segment (8 * bytes for a byte
+*                              threshold)
+*                safePoints - true to end segments only at MarkSafePoint
+*                bufferSize - compact mode buffer size of each segment
+*   Effects    : Creates the first segment file and starts a thread.
+*   Returned   : None
+*   Exception  : "Error: Invalid Segment Size" - if segmentBits is 0
+*                "Error: Unable To Open File" - if the first segment
+*                cannot be opened
+***************************************************************************/
+bit_rolling_writer_c::bit_rolling_writer_c(const char *baseName,
+    const uint64_t segmentBits, const bool safePoints,
+    const unsigned int bufferSize) :
+    m_BaseName(baseName),
+    m_Limit(segmentBits),
+    m_SafePoints(safePoints),
+    m_BufferSize(bufferSize),
+    m_File(NULL),
+    m_Segment(0),
+    m_Bits(0),
+    m_Next(NULL),
+    m_Prepare(true),
+    m_Prepared(1),
+    m_Failures(0),
+    m_Stop(false)
+{
+    if (0 == segmentBits)
+    {
+        throw("Error: Invalid Segment Size");
+    }
+
+    m_File = OpenSegment(0);
+
+    if (NULL == m_File)
+    {
+        throw("Error: Unable To Open File");
+    }
+
+    m_Thread = thread(&bit_rolling_writer_c::Run, this);
+}
+
+/***************************************************************************
+*   Method     : ~bit_rolling_writer_c - destructor
+*   Description: This method closes every segment.
+*   Parameters : None
+*   Effects    : Closes files and stops the worker thread.
+*   Returned   : None
+***************************************************************************/
+bit_rolling_writer_c::~bit_rolling_writer_c(void)
+{
+    Close();
+}
+
+/***************************************************************************
+*   Method     : PutBit
+*   Description: This method writes a bit, starting a new segment first if
+*                the current one is full.
+*   Parameters : c - the bit value to write
+*   Effects    : Writes a bit to the current segment.
+*   Returned   : EOF for failure, otherwise the bit written.
+***************************************************************************/
+int bit_rolling_writer_c::PutBit(const int c)
+{
+    int returnValue;
+
+    if ((NULL == m_File) ||
+        ((!m_SafePoints) && (m_Bits >= m_Limit) && (Roll() == EOF)))
+    {
+        return EOF;
+    }
+
+    if ((returnValue = m_File->PutBit(c)) == EOF)
+    {
+        return EOF;
+    }
+
+    m_Bits++;
+    return returnValue;
+}
+
+/***************************************************************************
+*   Method     : PutChar
+*   Description: This method writes a byte.  It may be split between two
+*                segments.
+*   Parameters : c - the byte to write
+*   Effects    : Writes 8 bits.
+*   Returned   : EOF for failure, otherwise the byte written.
+***************************************************************************/
+int bit_rolling_writer_c::PutChar(const int c)
+{
+    unsigned char byte = (unsigned char)c;
+
+    if (PutBits(&byte, 8) == EOF)
+    {
+        return EOF;
+    }
+
+    return byte;
+}
+
+/***************************************************************************
+*   Method     : PutBits
+*   Description: This method writes the specified number of bits (msb to
+*                lsb).  Without safe points, a write that crosses the end
+*                of a segment is split so that each segment holds exactly
+*                segmentBits bits.
+*   Parameters : bits - pointer to bits to write
+*                count - number of bits to write
+*   Effects    : Writes bits to one or more segments.
+*   Returned   : EOF for failure, otherwise the number of bits written.
+***************************************************************************/
+int64_t bit_rolling_writer_c::PutBits(void *bits, const uint64_t count)
+{
+    unsigned char *bytes;
+    uint64_t done, length;
+
+    if ((NULL == m_File) || (bits == NULL))
+    {
+        return EOF;
+    }
+
+    bytes = (unsigned char *)bits;
+
+    for (done = 0; done < count; done += length)
+    {
+        if ((!m_SafePoints) && (m_Bits >= m_Limit) && (Roll() == EOF))
+        {
+            return EOF;
+        }
+
+        length = count - done;
+
+        if ((!m_SafePoints) && (length > (m_Limit - m_Bits)))
+        {
+            length = m_Limit - m_Bits;
+        }
+
+        if (0 == (done % 8))
+        {
+            if (m_File->PutBits(bytes + (done / 8), length) == EOF)
+            {
+                return EOF;
+            }
+        }
+        else
+        {
+            /* continue a split write from the middle of a byte */
+            unsigned char block[BF_ROLL_BLOCK];
+            bit_cursor_c cursor(bytes, (count + 7) / 8, done);
+            uint64_t moved, piece;
+
+            for (moved = 0; moved < length; moved += piece)
+            {
+                piece = length - moved;
+
+                if (piece > (8 * sizeof(block)))
+                {
+                    piece = 8 * sizeof(block);
+                }
+
+                if ((cursor.GetBits(block, piece) == EOF) ||
+                    (m_File->PutBits(block, piece) == EOF))
+                {
+                    return EOF;
+                }
+            }
+        }
+
+        m_Bits += length;
+    }
+
+    return (int64_t)count;
+}
+
+/***************************************************************************
+*   Method     : MarkSafePoint
+*   Description: This method marks a point where the stream may be split.
+*                With safe points enabled, a full segment ends here.
+*   Parameters : None
+*   Effects    : May start a new segment.
+*   Returned   : EOF for failure, 1 if a new segment was started,
+*                otherwise 0.
+***************************************************************************/
+int bit_rolling_writer_c::MarkSafePoint(void)
+{
+    if (NULL == m_File)
+    {
+        return EOF;
+    }
+
+    if ((!m_SafePoints) || (m_Bits < m_Limit))
+    {
+        return 0;
+    }
+
+    return (Roll() == EOF) ? EOF : 1;
+}
+
+/***************************************************************************
+*   Method     : Close
+*   Description: This method closes the current segment, waits for the
+*                worker to close the earlier ones and removes the unused
+*                segment it opened ahead.
+*   Parameters : None
+*   Effects    : Closes files and stops the worker thread.
+*   Returned   : EOF if any segment failed to open, write or close,
+*                otherwise 0.
+***************************************************************************/
+int bit_rolling_writer_c::Close(void)
+{
+    if (NULL == m_File)
+    {
+        return EOF;
+    }
+
+    {
+        lock_guard<mutex> lock(m_Lock);
+        m_Retired.push_back(m_File);
+        m_Stop = true;
+    }
+
+    m_File = NULL;
+    m_Wake.notify_one();
+    m_Thread.join();
+
+    if (m_Next != NULL)
+    {
+        /* opened ahead but never written */
+        m_Next->Close();
+        delete m_Next;
+        m_Next = NULL;
+        unlink(SegmentName(m_Segment + 1).c_str());
+    }
+
+    return (0 == m_Failures) ? 0 : EOF;
+}
+
+/***************************************************************************
+*   Method     : Segment
+*   Description: This method returns the number of the segment being
+*                written.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Segment number, starting from 0.
+***************************************************************************/
+unsigned int bit_rolling_writer_c::Segment(void) const
+{
+    return m_Segment;
+}
+
+/***************************************************************************
+*   Method     : SegmentBits
+*   Description: This method returns the number of bits written to the
+*                current segment.
+*   Parameters : None
+*   Effects    : None
+*   Returned   : Bits in the current segment.
+***************************************************************************/
+uint64_t bit_rolling_writer_c::SegmentBits(void) const
+{
+    return m_Bits;
+}
+
+/***************************************************************************
+*   Method     : SegmentName
+*   Description: This method returns the file name of a segment.
+*   Parameters : index - segment number
+*   Effects    : None
+*   Returned   : baseName.NNNNNN
+***************************************************************************/
+string bit_rolling_writer_c::SegmentName(const unsigned int index) const
+{
+    char suffix[16];
+
+    snprintf(suffix, sizeof(suffix), ".%06u", index);
+    return m_BaseName + suffix;
+}
+
+/***************************************************************************
+*   Method     : Roll
+*   Description: This method swaps in the segment the worker opened ahead
+*                and hands the current one to the worker to close.  It
+*                only waits if the worker hasn't finished opening it.
+*   Parameters : None
+*   Effects    : Changes the current segment.
+*   Returned   : EOF if the next segment couldn't be opened, otherwise 0.
+***************************************************************************/
+int bit_rolling_writer_c::Roll(void)
+{
+    bit_file_c *next;
+
+    {
+        unique_lock<mutex> lock(m_Lock);
+
+        while ((NULL == m_Next) && m_Prepare)
+        {
+            m_Ready.wait(lock);
+        }
+
+        if (NULL == m_Next)
+        {
+            return EOF;
+        }
+
+        next = m_Next;
+        m_Next = NULL;
+        m_Retired.push_back(m_File);
+        m_Prepare = true;
+        m_Prepared = m_Segment + 2;
+    }
+
+    m_Wake.notify_one();
+    m_File = next;
+    m_Segment++;
+    m_Bits = 0;
+    return 0;
+}
+
+/***************************************************************************
+*   Method     : Run
+*   Description: This method is the worker thread.  It closes retired
+*                segments and opens the next one, without holding the
+*                lock while it does file I/O.
+*   Parameters : None
+*   Effects    : Opens and closes segment files.
+*   Returned   : None
+***************************************************************************/
+void bit_rolling_writer_c::Run(void)
+{
+    unique_lock<mutex> lock(m_Lock);
+
+    for (;;)
+    {
+        vector<bit_file_c *> retired;
+        bit_file_c *next;
+        unsigned int failures, index;
+        bool prepare;
+        size_t i;
+
+        m_Wake.wait(lock, [this]
+            { return m_Stop || m_Prepare || !m_Retired.empty(); });
+
+        retired.swap(m_Retired);
+        prepare = m_Prepare && !m_Stop;
+        index = m_Prepared;
+
+        if (retired.empty() && !prepare)
+        {
+            /* stopping with nothing left to do */
+            break;
+        }
+
+        lock.unlock();
+        failures = 0;
+
+        for (i = 0; i < retired.size(); i++)
+        {
+            /* FlushOutput returns EOF for "nothing written" too */
+            retired[i]->FlushOutput(0);
+
+            if (retired[i]->bad())
+            {
+                failures++;
+            }
+
+            retired[i]->Close();
+            delete retired[i];
+        }
+
+        next = prepare ? OpenSegment(index) : NULL;
+        lock.lock();
+
+        m_Failures += failures;
+
+        if (prepare)
+        {
+            if (NULL == next)
+            {
+                m_Failures++;
+            }
+
+            m_Next = next;
+            m_Prepare = false;
+            m_Ready.notify_all();
+        }
+    }
+}
+
+/***************************************************************************
+*   Method     : OpenSegment
+*   Description: This method creates a segment file and, where the file
+*                system supports it, reserves room for a full segment
+*                without changing the file's size.
+*   Parameters : index - segment number
+*   Effects    : Creates a file.
+*   Returned   : The open segment, or NULL if it couldn't be opened.
+***************************************************************************/
+bit_file_c *bit_rolling_writer_c::OpenSegment(const unsigned int index)
+{
+    string name = SegmentName(index);
+    bit_file_c *segment;
+
+    try
+    {
+        segment = new bit_file_c(name.c_str(), BF_WRITE, m_BufferSize);
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+
+#if defined(__linux__) && defined(FALLOC_FL_KEEP_SIZE)
+    int fd = open(name.c_str(), O_WRONLY);
+
+    if (fd >= 0)
+    {
+        /* best effort; segments still grow normally without it */
+        fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, (off_t)((m_Limit + 7) / 8));
+        close(fd);
+    }
+#endif
+
+    return segment;
+}
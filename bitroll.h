@@ -0,0 +1,120 @@
+/***************************************************************************
+*                      Rolling Segment Writer Header
+*
+*   File    : bitroll.h
+*   Purpose : Provides definitions for bit_rolling_writer_c, which writes
+*             one long bit stream as a series of size capped segment
+*             files named <baseName>.000000, <baseName>.000001, ...
+*             A background thread opens and preallocates the next segment
+*             before it is needed and closes finished segments, so rolling
+*             over never waits for the file system.
+*
+*             By default a segment ends exactly at the threshold, and a
+*             write that crosses it is split between two segments.  With
+*             safe points, a segment is only ended by MarkSafePoint()
+*             once it has reached the threshold, so every segment starts
+*             at a point the caller can decode from.  Either way, the
+*             last byte of a segment is padded with zeros if it is
+*             partial.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITROLL_H
+#define __BITROLL_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "bitfile.h"
+
+/***************************************************************************
+*                               CONSTANTS
+***************************************************************************/
+/* default compact mode buffer size of each segment */
+#define BF_ROLL_BUFFER      (1 << 20)
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+class bit_rolling_writer_c
+{
+    public:
+        bit_rolling_writer_c(const char *baseName, const uint64_t segmentBits,
+            const bool safePoints = false,
+            const unsigned int bufferSize = BF_ROLL_BUFFER);
+        virtual ~bit_rolling_writer_c(void);
+
+        /* put single bit, byte, or number of bits */
+        int PutBit(const int c);
+        int PutChar(const int c);
+        int64_t PutBits(void *bits, const uint64_t count);
+
+        /* the stream may be split here; returns 1 if a new segment began */
+        int MarkSafePoint(void);
+
+        /* close every segment; returns EOF if any failed */
+        int Close(void);
+
+        /* current segment number and bits written to it */
+        unsigned int Segment(void) const;
+        uint64_t SegmentBits(void) const;
+
+        /* name of segment number index */
+        std::string SegmentName(const unsigned int index) const;
+
+    private:
+        std::string m_BaseName;         /* segment names start with this */
+        uint64_t m_Limit;               /* bits per segment */
+        bool m_SafePoints;              /* only roll at MarkSafePoint */
+        unsigned int m_BufferSize;      /* buffer size of each segment */
+
+        bit_file_c *m_File;             /* segment being written */
+        unsigned int m_Segment;         /* number of m_File */
+        uint64_t m_Bits;                /* bits written to m_File */
+
+        std::mutex m_Lock;              /* protects everything below */
+        std::condition_variable m_Wake; /* wakes the worker thread */
+        std::condition_variable m_Ready;    /* m_Next was prepared */
+        bit_file_c *m_Next;             /* opened next segment, or NULL */
+        bool m_Prepare;                 /* worker should open m_Prepared */
+        unsigned int m_Prepared;        /* number of segment to open */
+        std::vector<bit_file_c *> m_Retired;    /* segments to close */
+        unsigned int m_Failures;        /* segments that failed */
+        bool m_Stop;                    /* worker should exit */
+        std::thread m_Thread;           /* worker thread */
+
+        int Roll(void);
+        void Run(void);
+        bit_file_c *OpenSegment(const unsigned int index);
+
+        /* writers may not be copied */
+        bit_rolling_writer_c(const bit_rolling_writer_c &);
+        bit_rolling_writer_c &operator=(const bit_rolling_writer_c &);
+};
+
+#endif  /* ndef __BITROLL_H */
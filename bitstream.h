@@ -0,0 +1,343 @@
+/***************************************************************************
+*                   Header Only Bit Stream Template
+*
+*   File    : bitstream.h
+*   Purpose : Provides basic_bit_stream, a header only bit reader/writer
+*             template whose methods are all inline so that GetBit,
+*             PutBit, GetBits and PutBits compile into the caller's loops.
+*             It is specialized at compile time by:
+*
+*             Source      - where bytes come from/go to.  Needs
+*                           int ReadByte(void), returning 0 - 255 or EOF,
+*                           and/or int WriteByte(int), returning EOF on
+*                           failure.  bf_memory_source and
+*                           bf_bit_file_source are provided.
+*             BitOrder    - bf_msb_first (the bit_file_c order) or
+*                           bf_lsb_first (deflate style).
+*             Accumulator - unsigned type holding buffered bits.  GetBits
+*                           and PutBits handle up to its width - 8 bits.
+*
+*             A basic_bit_stream is used either for reading or for
+*             writing, not both.  Call Flush() when done writing.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __BITSTREAM_H
+#define __BITSTREAM_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bitfile.h"
+
+/***************************************************************************
+*                            BIT ORDER POLICIES
+* Bits are kept right justified in the accumulator; count is the number of
+* valid bits.  Bits above count may be garbage (msb first) or must be zero
+* (lsb first).
+***************************************************************************/
+
+/* first bit is the msb of each byte (bit_file_c order) */
+struct bf_msb_first
+{
+    /* add a byte read from the source after the buffered bits */
+    template <class A>
+    static inline void Append(A &acc, unsigned int &count, const int byte)
+    {
+        acc = (acc << 8) | (A)byte;
+        count += 8;
+    }
+
+    /* remove the next n bits (n <= count) */
+    template <class A>
+    static inline A Extract(A &acc, unsigned int &count,
+        const unsigned int n)
+    {
+        count -= n;
+        return (acc >> count) & (((A)1 << n) - 1);
+    }
+
+    /* add n bits to be written after the buffered bits */
+    template <class A>
+    static inline void Insert(A &acc, unsigned int &count, const A value,
+        const unsigned int n)
+    {
+        acc = (acc << n) | (value & (((A)1 << n) - 1));
+        count += n;
+    }
+
+    /* remove the first 8 buffered bits to be written (count >= 8) */
+    template <class A>
+    static inline int Emit(A &acc, unsigned int &count)
+    {
+        count -= 8;
+        return (int)((acc >> count) & 0xFF);
+    }
+
+    /* last partial byte, padded with 0 bits (count < 8) */
+    template <class A>
+    static inline int Pad(const A acc, const unsigned int count)
+    {
+        return (int)((acc << (8 - count)) & 0xFF);
+    }
+};
+
+/* first bit is the lsb of each byte */
+struct bf_lsb_first
+{
+    template <class A>
+    static inline void Append(A &acc, unsigned int &count, const int byte)
+    {
+        acc |= (A)byte << count;
+        count += 8;
+    }
+
+    template <class A>
+    static inline A Extract(A &acc, unsigned int &count,
+        const unsigned int n)
+    {
+        A value = acc & (((A)1 << n) - 1);
+
+        acc = (n < 8 * sizeof(A)) ? (acc >> n) : 0;
+        count -= n;
+        return value;
+    }
+
+    template <class A>
+    static inline void Insert(A &acc, unsigned int &count, const A value,
+        const unsigned int n)
+    {
+        acc |= (value & (((A)1 << n) - 1)) << count;
+        count += n;
+    }
+
+    template <class A>
+    static inline int Emit(A &acc, unsigned int &count)
+    {
+        int byte = (int)(acc & 0xFF);
+
+        acc >>= 8;
+        count -= 8;
+        return byte;
+    }
+
+    template <class A>
+    static inline int Pad(const A acc, const unsigned int count)
+    {
+        return (int)(acc & ((1U << count) - 1));
+    }
+};
+
+/***************************************************************************
+*                                SOURCES
+***************************************************************************/
+
+/* bytes in caller owned memory */
+class bf_memory_source
+{
+    public:
+        bf_memory_source(void *data, const size_t size) :
+            m_Data((unsigned char *)data), m_Size(size), m_Pos(0) {}
+
+        inline int ReadByte(void)
+        {
+            return (m_Pos < m_Size) ? m_Data[m_Pos++] : EOF;
+        }
+
+        inline int WriteByte(const int c)
+        {
+            if (m_Pos >= m_Size)
+            {
+                return EOF;
+            }
+
+            m_Data[m_Pos++] = (unsigned char)c;
+            return (c & 0xFF);
+        }
+
+        /* bytes read or written */
+        size_t Position(void) const { return m_Pos; }
+
+    private:
+        unsigned char *m_Data;
+        size_t m_Size;
+        size_t m_Pos;
+};
+
+/* bytes from/to a byte aligned bit_file_c */
+class bf_bit_file_source
+{
+    public:
+        bf_bit_file_source(bit_file_c &file) : m_File(file) {}
+
+        inline int ReadByte(void) { return m_File.GetChar(); }
+        inline int WriteByte(const int c) { return m_File.PutChar(c); }
+
+    private:
+        bit_file_c &m_File;
+};
+
+/***************************************************************************
+*                              BIT STREAM
+***************************************************************************/
+template <class Source, class BitOrder = bf_msb_first,
+    class Accumulator = uint64_t>
+class basic_bit_stream
+{
+    public:
+        typedef Accumulator accumulator_t;
+
+        /* most bits handled by one GetBits/PutBits call */
+        static const unsigned int MAX_BITS = (8 * sizeof(Accumulator)) - 8;
+
+        basic_bit_stream(const Source &source) :
+            m_Source(source), m_BitBuffer(0), m_BitCount(0) {}
+
+        Source &GetSource(void) { return m_Source; }
+
+        /* get/put single bit */
+        inline int GetBit(void)
+        {
+            if (0 == m_BitCount)
+            {
+                int c = m_Source.ReadByte();
+
+                if (EOF == c)
+                {
+                    return EOF;
+                }
+
+                BitOrder::Append(m_BitBuffer, m_BitCount, c);
+            }
+
+            return (int)BitOrder::Extract(m_BitBuffer, m_BitCount, 1);
+        }
+
+        inline int PutBit(const int c)
+        {
+            BitOrder::Insert(m_BitBuffer, m_BitCount, (Accumulator)(c != 0),
+                1);
+
+            if ((8 == m_BitCount) &&
+                (m_Source.WriteByte(BitOrder::Emit(m_BitBuffer, m_BitCount))
+                == EOF))
+            {
+                return EOF;
+            }
+
+            return c;
+        }
+
+        /* get/put up to MAX_BITS bits as a right justified value */
+        inline int GetBits(Accumulator *value, const unsigned int count)
+        {
+            if (count > MAX_BITS)
+            {
+                return EOF;
+            }
+
+            while (m_BitCount < count)
+            {
+                int c = m_Source.ReadByte();
+
+                if (EOF == c)
+                {
+                    /* bits already buffered stay unread */
+                    return EOF;
+                }
+
+                BitOrder::Append(m_BitBuffer, m_BitCount, c);
+            }
+
+            *value = (0 == count) ? 0 :
+                BitOrder::Extract(m_BitBuffer, m_BitCount, count);
+            return (int)count;
+        }
+
+        inline int PutBits(const Accumulator value, const unsigned int count)
+        {
+            if (count > MAX_BITS)
+            {
+                return EOF;
+            }
+
+            if (0 == count)
+            {
+                return 0;
+            }
+
+            BitOrder::Insert(m_BitBuffer, m_BitCount, value, count);
+
+            while (m_BitCount >= 8)
+            {
+                if (m_Source.WriteByte(BitOrder::Emit(m_BitBuffer,
+                    m_BitCount)) == EOF)
+                {
+                    return EOF;
+                }
+            }
+
+            return (int)count;
+        }
+
+        /* reading: toss bits left in a partially read byte */
+        int ByteAlign(void)
+        {
+            unsigned int discard = m_BitCount % 8;
+
+            if (discard != 0)
+            {
+                BitOrder::Extract(m_BitBuffer, m_BitCount, discard);
+            }
+
+            return (int)discard;
+        }
+
+        /* writing: pad the last byte with 0 bits and write it */
+        int Flush(void)
+        {
+            if (0 == m_BitCount)
+            {
+                return 0;
+            }
+
+            if (m_Source.WriteByte(BitOrder::Pad(m_BitBuffer, m_BitCount)) ==
+                EOF)
+            {
+                return EOF;
+            }
+
+            m_BitBuffer = 0;
+            m_BitCount = 0;
+            return 0;
+        }
+
+    private:
+        Source m_Source;                /* byte source/sink */
+        Accumulator m_BitBuffer;        /* bits waiting to be read/written */
+        unsigned int m_BitCount;        /* number of bits in m_BitBuffer */
+};
+
+#endif  /* ndef __BITSTREAM_H */
@@ -0,0 +1,378 @@
+/***************************************************************************
+*                       CRC-32C Checksum Implementation
+*
+*   File    : crc32c.cpp
+*   Purpose : This file implements CRC-32C (Castagnoli polynomial
+*             0x1EDC6F41, reflected 0x82F63B78) checksums.  x86 processors
+*             with SSE4.2 use the crc32 instruction.  Everything else uses
+*             a slicing-by-8 table implementation.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+/***************************************************************************
+*                             INCLUDED FILES
+***************************************************************************/
+#include <string.h>
+#include "crc32c.h"
+#include "bitcpu.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_X86
+#endif
+
+/***************************************************************************
+*                                CONSTANTS
+***************************************************************************/
+#define CRC32C_POLY     0x82F63B78UL    /* reflected Castagnoli polynomial */
+
+/***************************************************************************
+*                            TYPE DEFINITIONS
+***************************************************************************/
+typedef uint32_t (*crc32c_fn_t)(uint32_t crc, const unsigned char *data,
+    size_t len);
+
+/***************************************************************************
+*                                VARIABLES
+***************************************************************************/
+static uint32_t crcTable[8][256];           /* slicing-by-8 tables */
+static crc32c_fn_t crcImplementation = NULL;
+
+/***************************************************************************
+*                                FUNCTIONS
+***************************************************************************/
+
+/***************************************************************************
+*   Function   : Crc32cSoftware
+*   Description: This function updates an un-finalized CRC-32C using the
+*                slicing-by-8 tables.
+*   Parameters : crc - the current (inverted) crc value
+*                data - bytes to add to the crc
+*                len - number of bytes in data
+*   Effects    : None
+*   Returned   : The updated (inverted) crc value.
+***************************************************************************/
+static uint32_t Crc32cSoftware(uint32_t crc, const unsigned char *data,
+    size_t len)
+{
+    uint32_t lo, hi;
+
+    /* process a byte at a time until aligned */
+    while ((len > 0) && (((uintptr_t)data & 0x07) != 0))
+    {
+        crc = crcTable[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        data++;
+        len--;
+    }
+
+    while (len >= 8)
+    {
+        lo = (uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+            ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+        hi = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+            ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+        lo ^= crc;
+
+        crc = crcTable[7][lo & 0xFF] ^ crcTable[6][(lo >> 8) & 0xFF] ^
+            crcTable[5][(lo >> 16) & 0xFF] ^ crcTable[4][lo >> 24] ^
+            crcTable[3][hi & 0xFF] ^ crcTable[2][(hi >> 8) & 0xFF] ^
+            crcTable[1][(hi >> 16) & 0xFF] ^ crcTable[0][hi >> 24];
+
+        data += 8;
+        len -= 8;
+    }
+
+    while (len > 0)
+    {
+        crc = crcTable[0][(crc ^ *data) & 0xFF] ^ (crc >> 8);
+        data++;
+        len--;
+    }
+
+    return crc;
+}
+
+#ifdef CRC32C_X86
+/***************************************************************************
+*   Function   : Crc32cSse42
+*   Description: This function updates an un-finalized CRC-32C using the
+*                SSE4.2 crc32 instruction.
+*   Parameters : crc - the current (inverted) crc value
+*                data - bytes to add to the crc
+*                len - number of bytes in data
+*   Effects    : None
+*   Returned   : The updated (inverted) crc value.
+***************************************************************************/
+__attribute__((target("sse4.2")))
+static uint32_t Crc32cSse42(uint32_t crc, const unsigned char *data,
+    size_t len)
+{
+    while ((len > 0) && (((uintptr_t)data & 0x07) != 0))
+    {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        len--;
+    }
+
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+
+    while (len >= 8)
+    {
+        uint64_t word;
+
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        len -= 8;
+    }
+
+    crc = (uint32_t)crc64;
+#endif
+
+    while (len >= 4)
+    {
+        uint32_t word;
+
+        memcpy(&word, data, sizeof(word));
+        crc = _mm_crc32_u32(crc, word);
+        data += 4;
+        len -= 4;
+    }
+
+    while (len > 0)
+    {
+        crc = _mm_crc32_u8(crc, *data);
+        data++;
+        len--;
+    }
+
+    return crc;
+}
+#endif
+
+/***************************************************************************
+*   Function   : Crc32cBuild
+*   Description: This function builds the slicing-by-8 tables and selects
+*                the fastest implementation supported by the processor.
+*   Parameters : None
+*   Effects    : Initializes crcTable and crcImplementation.
+*   Returned   : true
+***************************************************************************/
+static bool Crc32cBuild(void)
+{
+    uint32_t crc;
+    int i, j;
+
+    for (i = 0; i < 256; i++)
+    {
+        crc = i;
+
+        for (j = 0; j < 8; j++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ CRC32C_POLY) : (crc >> 1);
+        }
+
+        crcTable[0][i] = crc;
+    }
+
+    for (i = 0; i < 256; i++)
+    {
+        crc = crcTable[0][i];
+
+        for (j = 1; j < 8; j++)
+        {
+            crc = crcTable[0][crc & 0xFF] ^ (crc >> 8);
+            crcTable[j][i] = crc;
+        }
+    }
+
+    crcImplementation = Crc32cSoftware;
+
+#ifdef CRC32C_X86
+    if (BitCpuFeatures() & BF_CPU_SSE42)
+    {
+        crcImplementation = Crc32cSse42;
+    }
+#endif
+
+    return true;
+}
+
+/***************************************************************************
+*   Function   : Crc32cInit
+*   Description: This function makes sure Crc32cBuild has been run exactly
+*                once, even if several threads get here at the same time.
+*   Parameters : None
+*   Effects    : Initializes crcTable and crcImplementation on first call.
+*   Returned   : None
+***************************************************************************/
+static void Crc32cInit(void)
+{
+    static const bool initialized = Crc32cBuild();
+
+    (void)initialized;
+}
+
+/***************************************************************************
+*   Function   : Crc32cUpdate
+*   Description: This function adds len bytes of data to a CRC-32C.  The
+*                crc passed in and returned is the finalized value, so the
+*                checksum of a buffer may be computed in pieces, starting
+*                with a crc of 0.
+*   Parameters : crc - the crc of the data that precedes this data
+*                data - bytes to add to the crc
+*                len - number of bytes in data
+*   Effects    : Initializes tables on first call.
+*   Returned   : The CRC-32C of the preceding data followed by data.
+***************************************************************************/
+uint32_t Crc32cUpdate(uint32_t crc, const void *data, size_t len)
+{
+    Crc32cInit();
+    return ~crcImplementation(~crc, (const unsigned char *)data, len);
+}
+
+/***************************************************************************
+*   Function   : Gf2MatrixTimes
+*   Description: This function multiplies a 32x32 GF(2) matrix by a vector.
+*   Parameters : matrix - 32 columns of the matrix
+*                vector - the vector to multiply
+*   Effects    : None
+*   Returned   : The product.
+***************************************************************************/
+static uint32_t Gf2MatrixTimes(const uint32_t *matrix, uint32_t vector)
+{
+    uint32_t sum = 0;
+
+    while (vector != 0)
+    {
+        if (vector & 1)
+        {
+            sum ^= *matrix;
+        }
+
+        vector >>= 1;
+        matrix++;
+    }
+
+    return sum;
+}
+
+/***************************************************************************
+*   Function   : Gf2MatrixSquare
+*   Description: This function squares a 32x32 GF(2) matrix.
+*   Parameters : square - 32 columns to receive the square
+*                matrix - 32 columns of the matrix to square
+*   Effects    : Writes square.
+*   Returned   : None
+***************************************************************************/
+static void Gf2MatrixSquare(uint32_t *square, const uint32_t *matrix)
+{
+    int n;
+
+    for (n = 0; n < 32; n++)
+    {
+        square[n] = Gf2MatrixTimes(matrix, matrix[n]);
+    }
+}
+
+/***************************************************************************
+*   Function   : Crc32cAdjust
+*   Description: This function corrects the CRC-32C of a message after len
+*                of its bytes have been changed by xoring them with delta.
+*                The changed bytes are followed by trailing unchanged bytes.
+*                Because the CRC is linear, only delta has to be processed;
+*                its effect is carried through the trailing bytes with
+*                log(trailing) matrix squarings instead of rereading them.
+*   Parameters : crc - the CRC-32C of the original message
+*                delta - the old bytes xor the new bytes
+*                len - number of bytes in delta
+*                trailing - number of message bytes after the changed ones
+*   Effects    : None
+*   Returned   : The CRC-32C of the changed message.
+***************************************************************************/
+uint32_t Crc32cAdjust(uint32_t crc, const void *delta, size_t len,
+    uint64_t trailing)
+{
+    uint32_t even[32], odd[32];
+    uint32_t change, row;
+    int n;
+
+    /* crc of delta with no pre or post conditioning */
+    Crc32cInit();
+    change = crcImplementation(0, (const unsigned char *)delta, len);
+
+    if ((0 == change) || (0 == trailing))
+    {
+        return crc ^ change;
+    }
+
+    /* operator for one zero bit */
+    odd[0] = CRC32C_POLY;
+    row = 1;
+
+    for (n = 1; n < 32; n++)
+    {
+        odd[n] = row;
+        row <<= 1;
+    }
+
+    Gf2MatrixSquare(even, odd);     /* two zero bits */
+    Gf2MatrixSquare(odd, even);     /* four zero bits */
+
+    /* apply trailing zero bytes, squaring for each bit of trailing */
+    for (;;)
+    {
+        Gf2MatrixSquare(even, odd);
+
+        if (trailing & 1)
+        {
+            change = Gf2MatrixTimes(even, change);
+        }
+
+        trailing >>= 1;
+
+        if (0 == trailing)
+        {
+            break;
+        }
+
+        Gf2MatrixSquare(odd, even);
+
+        if (trailing & 1)
+        {
+            change = Gf2MatrixTimes(odd, change);
+        }
+
+        trailing >>= 1;
+
+        if (0 == trailing)
+        {
+            break;
+        }
+    }
+
+    return crc ^ change;
+}
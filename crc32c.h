@@ -0,0 +1,50 @@
+/***************************************************************************
+*                          CRC-32C Checksum Header
+*
+*   File    : crc32c.h
+*   Purpose : Provides a prototype for computing CRC-32C (Castagnoli)
+*             checksums.  The checksum is used by the bit file class to
+*             compute a running checksum of the bytes it reads or writes.
+*   Author  : Michael Dipperstein
+*   Date    : October 18, 2026
+*
+****************************************************************************
+*
+* Bitfile: Bit Stream File I/O Class
+* Copyright (C) 2004-2007 by Michael Dipperstein (mdipperstein@gmail.com)
+*
+* This file is part of the bit file library.
+*
+* The bit file library is free software; you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License as
+* published by the Free Software Foundation; either version 3 of the
+* License, or (at your option) any later version.
+*
+* The bit file library is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+* General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+***************************************************************************/
+
+#ifndef __CRC32C_H
+#define __CRC32C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+
+/* update crc with len bytes of data.  start with crc = 0. */
+uint32_t Crc32cUpdate(uint32_t crc, const void *data, size_t len);
+
+/* fix crc after xoring delta into len bytes followed by trailing bytes */
+uint32_t Crc32cAdjust(uint32_t crc, const void *delta, size_t len,
+    uint64_t trailing);
+
+#endif  /* ndef __CRC32C_H */
@@ -53,8 +53,15 @@
 *
 ***************************************************************************/
 #include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
 #include <stdlib.h>
 #include "bitfile.h"
+#include "bitroll.h"
+#include "bitcommit.h"
+#include "bitrank.h"
 
 using namespace std;
 
@@ -63,6 +70,23 @@ using namespace std;
 ***************************************************************************/
 #define NUM_CALLS       5
 
+#define ROLL_BYTES      2000    /* data written by RollSegments */
+#define ROLL_LIMIT      1001    /* bits per segment, not a whole byte */
+
+#define COMMIT_THREADS  4       /* writers used by GroupCommit */
+#define COMMIT_FILES    8       /* files written by each of them */
+
+#define RANK_BYTES      65573   /* indexed by RankSelect, not whole blocks */
+
+/***************************************************************************
+*                               PROTOTYPES
+***************************************************************************/
+static bool ReadBack(bit_file_c &bf);
+static bool ScanByteBoundary(void);
+static bool RollSegments(void);
+static bool GroupCommit(void);
+static bool RankSelect(void);
+
 /***************************************************************************
 *                                FUNCTIONS
 ***************************************************************************/
@@ -183,6 +207,82 @@ int main()
         return (EXIT_FAILURE);
     }
 
+    if (!ReadBack(bf))
+    {
+        return (EXIT_FAILURE);
+    }
+
+    /* read it again in compact mode with a 64 byte buffer */
+    try
+    {
+        bf.Open("testfile", BF_READ, 64);
+    }
+    catch (const char *errorMsg)
+    {
+        cout << errorMsg << endl;
+        return (EXIT_FAILURE);
+    }
+    catch (...)
+    {
+        cout << "Unknown error opening file" << endl;
+        return (EXIT_FAILURE);
+    }
+
+    if (!ReadBack(bf))
+    {
+        return (EXIT_FAILURE);
+    }
+
+    /* run scans that end exactly at a byte boundary */
+    if (!ScanByteBoundary())
+    {
+        cerr << "Error: run scan at a byte boundary" << endl;
+        return (EXIT_FAILURE);
+    }
+
+    cout << "run scans at byte boundaries ok" << endl;
+
+    /* split a stream into segments of ROLL_LIMIT bits */
+    if (!RollSegments())
+    {
+        cerr << "Error: rolling segments" << endl;
+        return (EXIT_FAILURE);
+    }
+
+    cout << "rolling segments ok" << endl;
+
+    /* sync files from several writer threads together */
+    if (!GroupCommit())
+    {
+        cerr << "Error: group commit" << endl;
+        return (EXIT_FAILURE);
+    }
+
+    cout << "group commit ok" << endl;
+
+    /* rank/select directory against counting the bits */
+    if (!RankSelect())
+    {
+        cerr << "Error: rank/select" << endl;
+        return (EXIT_FAILURE);
+    }
+
+    cout << "rank/select ok" << endl;
+    return(EXIT_SUCCESS);
+}
+
+/***************************************************************************
+*   Function   : ReadBack
+*   Description: This function reads back the chars, bits and integers
+*                written by main, printing them to stdout.
+*   Parameters : bf - testfile opened for reading
+*   Effects    : Reads and closes bf.
+*   Returned   : true if every read succeeds.
+***************************************************************************/
+static bool ReadBack(bit_file_c &bf)
+{
+    int i, value;
+
     /* read chars */
     for (i = 0; i < NUM_CALLS; i++)
     {
@@ -191,7 +291,7 @@ int main()
         {
             cerr << "Error: reading char" << endl;
             bf.Close();
-            return (EXIT_FAILURE);
+            return false;
         }
         else
         {
@@ -207,7 +307,7 @@ int main()
         {
             cerr << "Error: reading bit" << endl;
             bf.Close();
-            return (EXIT_FAILURE);
+            return false;
         }
         else
         {
@@ -222,7 +322,7 @@ int main()
         {
             cerr << "Error: reading bits" << endl;
             bf.Close();
-            return (EXIT_FAILURE);
+            return false;
         }
         else
         {
@@ -238,7 +338,7 @@ int main()
         {
             cerr << "Error: reading bits from an integer" << endl;
             bf.Close();
-            return (EXIT_FAILURE);
+            return false;
         }
         else
         {
@@ -246,5 +346,517 @@ int main()
         }
     }
 
-    return(EXIT_SUCCESS);
+    bf.Close();
+    return true;
+}
+
+/***************************************************************************
+*   Function   : ScanByteBoundary
+*   Description: This function checks that FindNextSet and CountRun leave
+*                the file readable when the run ends at the first bit of a
+*                byte.  testfile is rewritten as 00 80 AB CD and read in
+*                stream, unbuffered compact and buffered compact modes.
+*   Parameters : None
+*   Effects    : Overwrites testfile.
+*   Returned   : true if every read returns the expected bits.
+***************************************************************************/
+static bool ScanByteBoundary(void)
+{
+    const unsigned char data[4] = {0x00, 0x80, 0xAB, 0xCD};
+    unsigned char bytes[2];
+    bit_file_c bf;
+    int mode;
+
+    try
+    {
+        bf.Open("testfile", BF_WRITE);
+        bf.PutBits((void *)data, 32);
+        bf.Close();
+
+        for (mode = 0; mode < 3; mode++)
+        {
+            /* FindNextSet, then whole bytes */
+            if (0 == mode)
+            {
+                bf.Open("testfile", BF_READ);
+            }
+            else
+            {
+                bf.Open("testfile", BF_READ, (1 == mode) ? 0 : 64);
+            }
+
+            if ((bf.FindNextSet() != 8) || (bf.GetChar() != 0x80) ||
+                (bf.GetBits(bytes, 16) != 16) || (bytes[0] != 0xAB) ||
+                (bytes[1] != 0xCD))
+            {
+                bf.Close();
+                return false;
+            }
+
+            bf.Close();
+
+            /* FindNextSet, then ByteAlign */
+            if (0 == mode)
+            {
+                bf.Open("testfile", BF_READ);
+            }
+            else
+            {
+                bf.Open("testfile", BF_READ, (1 == mode) ? 0 : 64);
+            }
+
+            if ((bf.FindNextSet() != 8) || (bf.ByteAlign() == EOF) ||
+                (bf.GetChar() != 0x80))
+            {
+                bf.Close();
+                return false;
+            }
+
+            /* CountRun of 0s at a byte starting with 1 */
+            if ((bf.CountRun(0, 100) != 0) || (bf.GetBits(bytes, 16) != 16) ||
+                (bytes[0] != 0xAB) || (bytes[1] != 0xCD))
+            {
+                bf.Close();
+                return false;
+            }
+
+            bf.Close();
+        }
+    }
+    catch (const char *errorMsg)
+    {
+        cerr << errorMsg << endl;
+        return false;
+    }
+
+    return true;
+}
+
+/***************************************************************************
+*   Function   : RollSegments
+*   Description: This function writes ROLL_BYTES of data through a
+*                bit_rolling_writer_c with ROLL_LIMIT bit segments, mixing
+*                single bits, chars and odd length PutBits calls so writes
+*                are split across many rollovers.  It then reads the
+*                segments back in order and checks they join up to the
+*                data, and that the segment opened ahead was removed.
+*   Parameters : None
+*   Effects    : Creates and removes rollfile.NNNNNN.
+*   Returned   : true if the segments hold exactly the data written.
+***************************************************************************/
+static bool RollSegments(void)
+{
+    static const unsigned int lengths[] = {1, 8, 13, 77, 300, 5};
+    unsigned char data[ROLL_BYTES], piece[300 / 8 + 1];
+    unsigned int i, segment, segments, call;
+    uint64_t total, pos, bits, j;
+    bool ok;
+    FILE *fp;
+
+    /* data to write */
+    for (i = 0; i < ROLL_BYTES; i++)
+    {
+        data[i] = (unsigned char)((i * 167) ^ (i >> 3));
+    }
+
+    total = 8 * ROLL_BYTES;
+    segments = (unsigned int)((total + ROLL_LIMIT - 1) / ROLL_LIMIT);
+
+    try
+    {
+        bit_rolling_writer_c roll("rollfile", ROLL_LIMIT, false, 256);
+
+        for (pos = 0, call = 0; pos < total; pos += bits, call++)
+        {
+            bits = lengths[call % (sizeof(lengths) / sizeof(lengths[0]))];
+
+            if (bits > (total - pos))
+            {
+                bits = total - pos;
+            }
+
+            /* copy the next bits, msb first, to the start of piece */
+            for (j = 0; j < (bits + 7) / 8; j++)
+            {
+                piece[j] = 0;
+            }
+
+            for (j = 0; j < bits; j++)
+            {
+                if (data[(pos + j) / 8] & (0x80 >> ((pos + j) % 8)))
+                {
+                    piece[j / 8] |= 0x80 >> (j % 8);
+                }
+            }
+
+            if (1 == bits)
+            {
+                ok = (roll.PutBit(piece[0] >> 7) != EOF);
+            }
+            else if (8 == bits)
+            {
+                ok = (roll.PutChar(piece[0]) == piece[0]);
+            }
+            else
+            {
+                ok = (roll.PutBits(piece, bits) == (int64_t)bits);
+            }
+
+            if (!ok)
+            {
+                return false;
+            }
+        }
+
+        if ((roll.Segment() != segments - 1) || (roll.Close() == EOF))
+        {
+            return false;
+        }
+
+        /* read the segments back in order */
+        ok = true;
+        pos = 0;
+
+        for (segment = 0; segment < segments; segment++)
+        {
+            bit_file_c bf(roll.SegmentName(segment).c_str(), BF_READ);
+
+            bits = total - pos;
+
+            if (bits > ROLL_LIMIT)
+            {
+                bits = ROLL_LIMIT;
+            }
+
+            for (j = 0; j < bits; j++, pos++)
+            {
+                if (bf.GetBit() !=
+                    ((data[pos / 8] >> (7 - (pos % 8))) & 1))
+                {
+                    ok = false;
+                }
+            }
+
+            /* nothing but padding after the segment's bits */
+            if (bf.GetBits(piece, 8) != EOF)
+            {
+                ok = false;
+            }
+
+            bf.Close();
+            remove(roll.SegmentName(segment).c_str());
+        }
+
+        /* the segment opened ahead must be gone */
+        if ((fp = fopen(roll.SegmentName(segments).c_str(), "rb")) != NULL)
+        {
+            fclose(fp);
+            remove(roll.SegmentName(segments).c_str());
+            ok = false;
+        }
+    }
+    catch (const char *errorMsg)
+    {
+        cerr << errorMsg << endl;
+        return false;
+    }
+
+    return ok;
+}
+
+/***************************************************************************
+*   Function   : GroupCommitWriter
+*   Description: This function is a GroupCommit writer thread.  It writes
+*                COMMIT_FILES compact mode files with BF_DURABLE_GROUP,
+*                then waits for them to be synced.
+*   Parameters : committer - committer shared by the writers
+*                writer - number of this writer
+*                ok - set to false if anything fails
+*   Effects    : Creates commitfile.writer.N
+*   Returned   : None
+***************************************************************************/
+static void GroupCommitWriter(bit_committer_c *committer,
+    const unsigned int writer, bool *ok)
+{
+    unsigned int i;
+
+    for (i = 0; i < COMMIT_FILES; i++)
+    {
+        string name = "commitfile." + to_string(writer) + "." + to_string(i);
+
+        try
+        {
+            bit_file_c bf(name.c_str(), BF_WRITE, 64);
+
+            if ((bf.SetDurability(BF_DURABLE_GROUP, committer) == EOF) ||
+                (bf.PutChar((int)(writer * COMMIT_FILES + i)) == EOF) ||
+                (bf.PutBit(1) == EOF))
+            {
+                *ok = false;
+            }
+
+            /* Close flushes the file and registers it */
+            bf.Close();
+        }
+        catch (...)
+        {
+            *ok = false;
+        }
+    }
+
+    /* everything this writer registered is durable once Sync returns */
+    if ((committer->Sync() == EOF) || (0 == committer->Batches()))
+    {
+        *ok = false;
+    }
+}
+
+/***************************************************************************
+*   Function   : GroupCommit
+*   Description: This function checks SetDurability's argument checks, and
+*                has COMMIT_THREADS writers register files with one
+*                bit_committer_c at the same time.  The committer's
+*                interval is long, so only Sync() can start the batches in
+*                time.  The files are read back afterwards.
+*   Parameters : None
+*   Effects    : Creates and removes commitfile.W.N
+*   Returned   : true if the files were synced and read back.
+***************************************************************************/
+static bool GroupCommit(void)
+{
+    bool ok[COMMIT_THREADS];
+    thread writers[COMMIT_THREADS];
+    unsigned int i, j;
+    bool result;
+    bit_file_c bf;
+
+    try
+    {
+        /* stream mode files have no descriptor to sync */
+        bit_committer_c committer(60000);
+
+        bf.Open("testfile", BF_WRITE);
+
+        if ((bf.SetDurability(BF_DURABLE_FLUSH) != EOF) ||
+            (bf.SetDurability(BF_DURABLE_GROUP, &committer) != EOF))
+        {
+            bf.Close();
+            return false;
+        }
+
+        bf.Close();
+
+        /* group durability needs a committer */
+        bf.Open("testfile", BF_WRITE, 64);
+
+        if ((bf.SetDurability(BF_DURABLE_GROUP, NULL) != EOF) ||
+            (bf.SetDurability(BF_DURABLE_FLUSH) != 0) ||
+            (bf.PutChar('A') == EOF))
+        {
+            bf.Close();
+            return false;
+        }
+
+        /* FlushOutput returns EOF for "nothing written" too */
+        bf.FlushOutput(0);
+
+        if (bf.bad())
+        {
+            bf.Close();
+            return false;
+        }
+
+        bf.Close();
+
+        /* nothing registered yet */
+        if ((committer.Register(-1) != EOF) || (committer.Sync() != 0) ||
+            (committer.Batches() != 0))
+        {
+            return false;
+        }
+
+        for (i = 0; i < COMMIT_THREADS; i++)
+        {
+            ok[i] = true;
+            writers[i] = thread(GroupCommitWriter, &committer, i, &ok[i]);
+        }
+
+        for (i = 0; i < COMMIT_THREADS; i++)
+        {
+            writers[i].join();
+        }
+
+        result = (committer.Sync() == 0) && (committer.Failures() == 0) &&
+            (committer.Batches() >= 1) &&
+            (committer.Batches() <= COMMIT_THREADS * COMMIT_FILES);
+
+        for (i = 0; i < COMMIT_THREADS; i++)
+        {
+            result = result && ok[i];
+
+            for (j = 0; j < COMMIT_FILES; j++)
+            {
+                string name = "commitfile." + to_string(i) + "." +
+                    to_string(j);
+
+                bf.Open(name.c_str(), BF_READ);
+
+                if ((bf.GetChar() != (int)(i * COMMIT_FILES + j)) ||
+                    (bf.GetBit() != 1))
+                {
+                    result = false;
+                }
+
+                bf.Close();
+                remove(name.c_str());
+            }
+        }
+    }
+    catch (const char *errorMsg)
+    {
+        cerr << errorMsg << endl;
+        return false;
+    }
+
+    return result;
+}
+
+/***************************************************************************
+*   Function   : RankSelect
+*   Description: This function builds a rank/select directory for
+*                RANK_BYTES of data with dense, sparse, empty and full
+*                stretches, and checks Rank1, Rank0 and Select1 at every
+*                position against a running count of the bits.  It also
+*                checks that a directory whose select samples were dropped
+*                is rejected.
+*   Parameters : None
+*   Effects    : Creates and removes rankfile, rankfile.idx and
+*                rankfile.bad.
+*   Returned   : true if every query matches the count.
+***************************************************************************/
+static bool RankSelect(void)
+{
+    static const unsigned char masks[] = {0xFF, 0x01, 0x00, 0xFF, 0x11};
+    vector<unsigned char> data(RANK_BYTES), index;
+    uint64_t position, rank, *header;
+    uint32_t random;
+    unsigned int i;
+    bool result;
+    FILE *fp;
+    long size;
+
+    random = 1;
+
+    for (i = 0; i < RANK_BYTES; i++)
+    {
+        random = (random * 1103515245) + 12345;
+        data[i] = (unsigned char)(random >> 16) &
+            masks[(i / 4096) % sizeof(masks)];
+
+        if (3 == (i / 4096) % sizeof(masks))
+        {
+            data[i] = 0xFF;
+        }
+    }
+
+    result = true;
+
+    try
+    {
+        bit_file_c bf("rankfile", BF_WRITE);
+        bit_rank_builder_c builder;
+
+        if (bf.PutBits(&data[0], 8 * (uint64_t)RANK_BYTES) == EOF)
+        {
+            return false;
+        }
+
+        bf.Close();
+
+        if ((builder.AddFile("rankfile") == EOF) ||
+            (builder.Write("rankfile.idx") == EOF))
+        {
+            return false;
+        }
+
+        bit_mapping_c bits("rankfile");
+        bit_rank_index_c rankIndex(bits, "rankfile.idx");
+
+        rank = 0;
+
+        for (position = 0; position < bits.Bits(); position++)
+        {
+            if ((rankIndex.Rank1(position) != rank) ||
+                (rankIndex.Rank0(position) != position - rank))
+            {
+                result = false;
+                break;
+            }
+
+            if (data[position / 8] & (0x80 >> (position % 8)))
+            {
+                if (rankIndex.Select1(rank) != (int64_t)position)
+                {
+                    result = false;
+                    break;
+                }
+
+                rank++;
+            }
+        }
+
+        if ((rankIndex.Ones() != rank) ||
+            (rankIndex.Rank1(bits.Bits()) != rank) ||
+            (rankIndex.Select1(rank) != EOF))
+        {
+            result = false;
+        }
+
+        /* a directory without select samples for its 1 bits */
+        if ((fp = fopen("rankfile.idx", "rb")) != NULL)
+        {
+            fseek(fp, 0, SEEK_END);
+            size = ftell(fp);
+            rewind(fp);
+            index.resize(size);
+
+            if (fread(&index[0], 1, size, fp) != (size_t)size)
+            {
+                result = false;
+            }
+
+            fclose(fp);
+        }
+
+        header = (uint64_t *)&index[0];
+        index.resize(index.size() - (header[4] * sizeof(uint64_t)));
+        header = (uint64_t *)&index[0];
+        header[4] = 0;
+
+        if ((fp = fopen("rankfile.bad", "wb")) != NULL)
+        {
+            fwrite(&index[0], 1, index.size(), fp);
+            fclose(fp);
+        }
+
+        try
+        {
+            bit_rank_index_c badIndex(bits, "rankfile.bad");
+            result = false;
+        }
+        catch (const char *)
+        {
+            /* expected */
+        }
+    }
+    catch (const char *errorMsg)
+    {
+        cerr << errorMsg << endl;
+        result = false;
+    }
+
+    remove("rankfile");
+    remove("rankfile.idx");
+    remove("rankfile.bad");
+    return result;
 }